@@ -0,0 +1,114 @@
+//
+//  Arena.hpp
+//
+//	Chunked memory arena, used to store the Point and Segment objects of the
+//	registries: objects are carved out of a few large chunks, never move, and
+//	their memory is returned all at once when the arena is destroyed.
+//
+
+#ifndef Arena_hpp
+#define Arena_hpp
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+namespace geometry {
+
+	class Arena{
+
+		private:
+
+			/**	Size of the first chunk.  Each new chunk is twice as large as the
+			 *	previous one, up to MAX_CHUNK_SIZE, so that a large scene only takes
+			 *	a handful of chunks.
+			 */
+			static constexpr size_t FIRST_CHUNK_SIZE = 64 * 1024;
+			static constexpr size_t MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+
+			std::vector<std::unique_ptr<std::byte[]> > chunks_;
+			size_t nextChunkSize_;
+			/**	Free part of the current chunk */
+			std::byte* current_;
+			size_t available_;
+			size_t bytesAllocated_;
+
+			/**	Starts a new chunk that has room for at least size bytes */
+			void newChunk_(size_t size);
+
+		public:
+
+			Arena(void);
+
+			//	Disabled constructors and operators.  Objects in the arena point into it.
+			Arena(const Arena& ) = delete;
+			Arena(Arena&& ) = delete;
+			Arena& operator = (const Arena& ) = delete;
+			Arena& operator = (Arena&& ) = delete;
+
+			~Arena(void) = default;
+
+			/**	Allocates a block that stays valid as long as the arena exists.
+			 *	Not thread-safe.
+			 *	@param size	the size of the block, in bytes
+			 *	@param alignment	a power of 2, at most alignof(std::max_align_t)
+			 */
+			void* allocate(size_t size, size_t alignment);
+
+			inline size_t getNumChunks(void) const{
+				return chunks_.size();
+			}
+
+			/**	Total size of the blocks allocated so far */
+			inline size_t getBytesAllocated(void) const{
+				return bytesAllocated_;
+			}
+	};
+
+	/**	Standard allocator that takes its memory from an Arena.  deallocate does nothing:
+	 *	the memory is returned when the arena is destroyed.  Each copy of the allocator
+	 *	shares ownership of the arena, so when it is passed to std::allocate_shared, the
+	 *	arena lives until the last object allocated in it is gone.
+	 */
+	template <typename T>
+	class ArenaAllocator{
+
+		template <typename U> friend class ArenaAllocator;
+
+		private:
+
+			std::shared_ptr<Arena> arena_;
+
+		public:
+
+			using value_type = T;
+			//	containers that are assigned or swapped take the other container's arena along
+			using propagate_on_container_copy_assignment = std::true_type;
+			using propagate_on_container_move_assignment = std::true_type;
+			using propagate_on_container_swap = std::true_type;
+
+			explicit ArenaAllocator(std::shared_ptr<Arena> arena)
+				:	arena_(std::move(arena))
+			{}
+
+			template <typename U>
+			ArenaAllocator(const ArenaAllocator<U>& other)
+				:	arena_(other.arena_)
+			{}
+
+			T* allocate(size_t n){
+				return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+			}
+
+			void deallocate(T* , size_t ){
+			}
+
+			template <typename U>
+			bool operator == (const ArenaAllocator<U>& other) const{
+				return arena_ == other.arena_;
+			}
+	};
+}
+
+#endif /* Arena_hpp */
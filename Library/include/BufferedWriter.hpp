@@ -0,0 +1,98 @@
+//
+//  BufferedWriter.hpp
+//
+//	Output file with a large buffer, for the writers of scene files and of
+//	temporary files.
+//
+
+#ifndef BufferedWriter_hpp
+#define BufferedWriter_hpp
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <charconv>
+#include <cstddef>
+
+namespace geometry {
+
+	/**	Output file with a large buffer that we format text lines in directly, or
+	 *	copy binary records to.  The file is only written when the buffer is full.
+	 */
+	class BufferedWriter{
+
+		private:
+
+			std::ofstream outFile_;
+			std::vector<char> buffer_;
+			size_t size_;
+
+		public:
+
+			/**	Room guaranteed by reserveLine, more than any single line we write */
+			static constexpr size_t MAX_LINE_SIZE = 256;
+
+			static constexpr size_t DEFAULT_BUFFER_SIZE = 1 << 20;
+
+			/**	@param filePath	the file to create (or truncate).  Check isOpen() for success.
+			 *	@param bufferSize	size of the buffer, at least MAX_LINE_SIZE
+			 */
+			explicit BufferedWriter(const std::string& filePath, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+			//	Disabled constructors and operators
+			BufferedWriter(const BufferedWriter& ) = delete;
+			BufferedWriter& operator = (const BufferedWriter& ) = delete;
+
+			BufferedWriter(BufferedWriter&& other) noexcept;
+			BufferedWriter& operator = (BufferedWriter&& other);
+
+			/**	Writes what is left in the buffer if close() wasn't called, ignoring
+			 *	errors: a caller that wants to know if the file is complete calls close().
+			 */
+			~BufferedWriter(void);
+
+			inline bool isOpen(void) const{
+				return outFile_.is_open();
+			}
+
+			void flush(void);
+
+			/**	Makes room for a line (up to MAX_LINE_SIZE characters), and returns where to write it */
+			inline char* reserveLine(void){
+				if (size_ + MAX_LINE_SIZE > buffer_.size()){
+					flush();
+				}
+				return buffer_.data() + size_;
+			}
+
+			/**	Ends the line started by reserveLine
+			 *	@param end	one past the last character of the line
+			 */
+			inline void commitLine(char* end){
+				size_ = static_cast<size_t>(end - buffer_.data());
+			}
+
+			/**	Appends bytes to the file */
+			void write(const void* data, size_t size);
+
+			inline void write(std::string_view text){
+				write(text.data(), text.size());
+			}
+
+			/**	Writes out the buffer and closes the file
+			 *	@return false if any write failed
+			 */
+			bool close(void);
+
+			/**	Formats a number at out with the shortest representation that reads back as the same value
+			 *	@return one past the last character written
+			 */
+			template <typename T>
+			static inline char* formatNumber(char* out, T val){
+				return std::to_chars(out, out + 64, val).ptr;
+			}
+	};
+}
+
+#endif /* BufferedWriter_hpp */
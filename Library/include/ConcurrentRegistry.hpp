@@ -0,0 +1,218 @@
+//
+//  ConcurrentRegistry.hpp
+//
+//	Registry that several threads (e.g. the threads of a parallel loader) can
+//	add points and segments to at the same time, with the same deduplication
+//	as the makers of Scene.  The points and segments added are only published
+//	in the scene by commit().
+//
+
+#ifndef ConcurrentRegistry_hpp
+#define ConcurrentRegistry_hpp
+
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <array>
+#include <bit>
+#include <unordered_map>
+#include <cstdint>
+#include "Arena.hpp"
+#include "Point.hpp"
+#include "Segment.hpp"
+
+namespace geometry {
+
+	class Scene;
+
+	/**	The new points are sharded by grid cell of the scene's point grid, the new
+	 *	segments by pair of endpoints, and each shard has its own lock.  To look for
+	 *	a duplicate, a thread locks the shard of the grid cell of the point, so two
+	 *	threads adding the same point are serialized and the second one finds the
+	 *	point of the first.  Adding points in different parts of the world, or
+	 *	segments, rarely contends.  Indices are assigned from atomic counters and
+	 *	follow those of the scene, so the handles returned stay valid after commit().
+	 *	The index of a segment is taken while the lists of segments of its endpoints
+	 *	are locked, so that these lists stay in increasing order of index.
+	 *
+	 *	The scene must not be modified in any other way between the construction of
+	 *	the registry (or its last commit) and the next commit.
+	 *
+	 *	The registry does more work than the makers of Scene: every insert takes
+	 *	locks, and each new point and segment is indexed once in its shard and once
+	 *	more in the scene by commit().  On a single thread, adding 1M short segments
+	 *	takes about 7 s through the registry against 3.5 s through the makers of
+	 *	Scene, so it only pays off when enough threads add to the same scene.  The
+	 *	loaders of the library still fill their scenes from one thread.  The
+	 *	insert_concurrent benchmark of segmentBenchmark measures how it scales with
+	 *	the number of threads.
+	 */
+	class ConcurrentRegistry{
+
+		private:
+
+			/**	Append-only array of shared pointers that can grow while other threads
+			 *	use it: the slots are allocated in blocks of doubling size that never move.
+			 */
+			template <typename T>
+			class Slots_{
+
+				private:
+
+					static constexpr size_t FIRST_BLOCK_SIZE = 1024;
+					//	enough blocks for 2^32 slots
+					static constexpr unsigned int NUM_BLOCKS = 23;
+
+					std::array<std::atomic<std::shared_ptr<T>*>, NUM_BLOCKS> blocks_;
+
+					inline static unsigned int block_(size_t k, size_t& offset){
+						const unsigned int b = static_cast<unsigned int>(std::bit_width(k / FIRST_BLOCK_SIZE + 1) - 1);
+						offset = k - FIRST_BLOCK_SIZE * ((size_t(1) << b) - 1);
+						return b;
+					}
+
+				public:
+
+					Slots_(void){
+						for (auto& block : blocks_){
+							block.store(nullptr, std::memory_order_relaxed);
+						}
+					}
+
+					Slots_(const Slots_& ) = delete;
+					Slots_& operator = (const Slots_& ) = delete;
+
+					~Slots_(void){
+						clear();
+					}
+
+					/**	The slot of index k, allocated if needed.  Thread-safe. */
+					std::shared_ptr<T>& operator[](size_t k){
+						size_t offset;
+						const unsigned int b = block_(k, offset);
+						std::shared_ptr<T>* block = blocks_[b].load(std::memory_order_acquire);
+						if (block == nullptr){
+							std::shared_ptr<T>* newBlock = new std::shared_ptr<T>[FIRST_BLOCK_SIZE << b];
+							if (blocks_[b].compare_exchange_strong(block, newBlock, std::memory_order_acq_rel)){
+								block = newBlock;
+							}else{
+								delete [] newBlock;
+							}
+						}
+						return block[offset];
+					}
+
+					/**	The slot of index k, which must have been allocated */
+					const std::shared_ptr<T>& at(size_t k) const{
+						size_t offset;
+						const unsigned int b = block_(k, offset);
+						return blocks_[b].load(std::memory_order_acquire)[offset];
+					}
+
+					/**	Frees all the slots.  Not thread-safe. */
+					void clear(void){
+						for (auto& block : blocks_){
+							delete [] block.exchange(nullptr);
+						}
+					}
+			};
+
+			struct alignas(64) PointShard_{
+				std::mutex mutex;
+				/**	the arena the points of the shard are allocated in */
+				std::shared_ptr<Arena> arena;
+				/**	the new points of the shard, by grid cell (see Scene::pointGrid_) */
+				std::unordered_multimap<uint64_t, unsigned int, Key64Hash> grid;
+			};
+
+			struct alignas(64) SegmentShard_{
+				std::mutex mutex;
+				std::shared_ptr<Arena> arena;
+				/**	the new segments of the shard, by pair of endpoints (see Scene::segIndex_) */
+				std::unordered_map<uint64_t, unsigned int, Key64Hash> index;
+			};
+
+			/**	Number of locks that guard the lists of segments of the points */
+			static constexpr unsigned int NUM_POINT_LOCKS = 256;
+
+			Scene& scene_;
+			unsigned int numShards_;
+			std::unique_ptr<PointShard_[]> pointShards_;
+			std::unique_ptr<SegmentShard_[]> segShards_;
+			std::array<std::mutex, NUM_POINT_LOCKS> pointLocks_;
+
+			/**	Indices of the first new point and segment (the sizes of the scene) */
+			unsigned int pointBase_;
+			unsigned int segBase_;
+			/**	Number of new points and segments */
+			std::atomic<unsigned int> numPoints_;
+			std::atomic<unsigned int> numSegs_;
+			/**	The new points and segments, by index minus the base index */
+			Slots_<Point> points_;
+			Slots_<Segment> segs_;
+
+			inline unsigned int shardOf_(uint64_t key) const{
+				return static_cast<unsigned int>(Key64Hash()(key) & (numShards_ - 1));
+			}
+
+			/**	The shared pointer to a point of the scene or a new point */
+			const std::shared_ptr<Point>& getPointPtr_(PointId id) const;
+
+			/**	Looks for a new point with exactly the coordinates passed.  The shard
+			 *	of its grid cell must be locked.
+			 *	@param key	the key of the grid cell of the point (see Scene::gridKey_)
+			 *	@return the index of the point, UINT_MAX if there is none
+			 */
+			unsigned int findNewPoint_(float xCoord, float yCoord, uint64_t key) const;
+
+			/**	Empties the shards and moves the base indices to the end of the scene */
+			void reset_(void);
+
+		public:
+
+			/**	@param scene	the scene to add the points and segments to
+			 *	@param numShards	number of shards of the points and of the segments.
+			 *					Rounded up to a power of 2.
+			 */
+			explicit ConcurrentRegistry(Scene& scene, unsigned int numShards = 64);
+
+			//	Disabled constructors and operators
+			ConcurrentRegistry(const ConcurrentRegistry& ) = delete;
+			ConcurrentRegistry(ConcurrentRegistry&& ) = delete;
+			ConcurrentRegistry& operator = (const ConcurrentRegistry& ) = delete;
+			ConcurrentRegistry& operator = (ConcurrentRegistry&& ) = delete;
+
+			/**	Commits the points and segments not committed yet */
+			~ConcurrentRegistry(void);
+
+			/**	Same as Scene::makeNewPointId.  Thread-safe.
+			 */
+			PointId makeNewPointId(float xCoord, float yCoord);
+
+			/**	Same as Scene::makeNewSegId.  Thread-safe.
+			 *	@param pt1, pt2	points of the scene, or new points of this registry
+			 */
+			SegmentId makeNewSegId(PointId pt1, PointId pt2);
+
+			/**	The coordinates of a point of the scene, or a new point of this registry.
+			 *	Thread-safe.
+			 */
+			PointStruct getCoordinates(PointId id) const;
+
+			inline unsigned int getNumNewPoints(void) const{
+				return numPoints_.load(std::memory_order_relaxed);
+			}
+
+			inline unsigned int getNumNewSegments(void) const{
+				return numSegs_.load(std::memory_order_relaxed);
+			}
+
+			/**	Adds the new points and segments to the scene, in the order of their
+			 *	indices.  Not thread-safe: all the threads must be done adding.  The
+			 *	registry can then be used to add more.
+			 */
+			void commit(void);
+	};
+}
+
+#endif /* ConcurrentRegistry_hpp */
@@ -0,0 +1,107 @@
+//
+//  Counters.hpp
+//
+//	Counters of the work done by the hot paths of the library (orientation tests,
+//	pair tests, sweep events, registry probes), to find out why a scene is slow.
+//	They are only compiled in when GEOMETRY_COUNTERS is 1: otherwise GEOMETRY_COUNT
+//	expands to nothing, and getCounters returns zeros.
+//
+
+#ifndef Counters_hpp
+#define Counters_hpp
+
+#include <cstddef>
+#include <cstdint>
+
+//	Defined to 1 by the build to count
+#ifndef GEOMETRY_COUNTERS
+	#define GEOMETRY_COUNTERS 0
+#endif
+
+#if GEOMETRY_COUNTERS
+	#include <atomic>
+#endif
+
+namespace geometry {
+
+	enum class Counter{
+		/**	Signs of orientation determinants computed (orientation(), isOnLeftSide, and
+		 *	the lanes of intersectsBatch; an ambiguous lane is counted again when redone exactly)
+		 */
+		ORIENTATION_TESTS,
+		/**	Orientation tests that needed the exact evaluation (nearly collinear points) */
+		EXACT_ORIENTATION_TESTS,
+		/**	Pairs of segments tested for intersection (Segment::intersects and the searches) */
+		SEGMENT_PAIR_TESTS,
+		/**	Intersection points computed (successful findIntersection, and the searches' results) */
+		INTERSECTION_POINTS,
+		/**	Events inserted in the queue of the plane sweep, and popped from it */
+		SWEEP_QUEUE_INSERTS,
+		SWEEP_QUEUE_POPS,
+		/**	Comparisons of two segments of the status line of the plane sweep */
+		SWEEP_STATUS_COMPARISONS,
+		/**	Points of the registries compared to a new point, in search of a duplicate */
+		POINT_REGISTRY_PROBES,
+		/**	Lookups of the endpoints of a new segment in the registries' segment indices */
+		SEGMENT_REGISTRY_PROBES
+	};
+
+	constexpr size_t NUM_COUNTERS = static_cast<size_t>(Counter::SEGMENT_REGISTRY_PROBES) + 1;
+
+	constexpr bool COUNTERS_ENABLED = GEOMETRY_COUNTERS != 0;
+
+	/**	Values of all the counters
+	 */
+	struct CounterValues{
+		uint64_t values[NUM_COUNTERS] = {};
+
+		inline uint64_t operator [] (Counter counter) const{
+			return values[static_cast<size_t>(counter)];
+		}
+	};
+
+	/**	Sums of the counters of all the threads, those still running and those that ended,
+	 *	since the last resetCounters.  The counts of the threads still counting may be missing
+	 *	their last few events.
+	 */
+	CounterValues getCounters(void);
+
+	/**	Starts the counts of getCounters over from zero, for all the threads */
+	void resetCounters(void);
+
+	/**	@return the name of a counter in the tools' output ("orientation_tests", ...) */
+	const char* getCounterName(Counter counter);
+
+#if GEOMETRY_COUNTERS
+	/**	The counters of a thread.  Only their thread writes them, so an increment is a
+	 *	plain load and store; getCounters reads them from other threads.
+	 */
+	struct ThreadCounters_{
+		std::atomic<uint64_t> values[NUM_COUNTERS];
+
+		/**	Registers the counters, so that getCounters can find them */
+		ThreadCounters_(void);
+
+		/**	Adds the counts to those of the ended threads */
+		~ThreadCounters_(void);
+
+		inline void add(Counter counter, uint64_t count){
+			std::atomic<uint64_t>& value = values[static_cast<size_t>(counter)];
+			value.store(value.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+		}
+	};
+
+	inline thread_local ThreadCounters_ threadCounters_;
+#endif
+}
+
+#if GEOMETRY_COUNTERS
+	#define GEOMETRY_COUNT_N(counter, count)	geometry::threadCounters_.add(geometry::Counter::counter, (count))
+#else
+	#define GEOMETRY_COUNT_N(counter, count)	((void)0)
+#endif
+
+/**	Counts an event, e.g. GEOMETRY_COUNT(SWEEP_QUEUE_POPS) */
+#define GEOMETRY_COUNT(counter)	GEOMETRY_COUNT_N(counter, 1)
+
+#endif /* Counters_hpp */
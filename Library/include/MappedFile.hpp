@@ -0,0 +1,55 @@
+//
+//  MappedFile.hpp
+//
+//	Read-only memory mapping of a whole file.
+//
+
+#ifndef MappedFile_hpp
+#define MappedFile_hpp
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+namespace geometry {
+
+	/**	Read-only memory mapping of a whole file, unmapped when destroyed.  The
+	 *	pages are only read from disk when they are accessed.  Files that can't
+	 *	be mapped (empty files, pipes, etc.) are read in memory instead.
+	 */
+	class MappedFile{
+
+		private:
+
+			void* map_;
+			size_t size_;
+			std::string contents_;
+			bool isOpen_;
+
+		public:
+
+			/**	@param filePath	the file to map.  Check isOpen() for success.
+			 */
+			explicit MappedFile(const std::string& filePath);
+
+			//	Disabled constructors and operators
+			MappedFile(const MappedFile& ) = delete;
+			MappedFile(MappedFile&& ) = delete;
+			MappedFile& operator = (const MappedFile& ) = delete;
+			MappedFile& operator = (MappedFile&& ) = delete;
+
+			~MappedFile(void);
+
+			inline bool isOpen(void) const{
+				return isOpen_;
+			}
+
+			/**	The contents of the file.  The mapping is page-aligned. */
+			std::string_view getText(void) const;
+
+			/**	Tells the kernel that the file will be read front to back, once */
+			void adviseSequential(void) const;
+	};
+}
+
+#endif /* MappedFile_hpp */
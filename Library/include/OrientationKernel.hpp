@@ -0,0 +1,53 @@
+//
+//  OrientationKernel.hpp
+//
+//	Batched version of the orientation tests of Segment::intersects, working
+//	on packed (structure of arrays) copies of the segments' endpoint coordinates.
+//
+
+#ifndef OrientationKernel_hpp
+#define OrientationKernel_hpp
+
+#include <cstddef>
+#include <cstdint>
+
+namespace geometry {
+
+	/**	Number of segments tested at once by intersectsBatch.  The coordinate
+	 *	arrays passed to intersectsBatch must be readable (and preferably
+	 *	padded with zeros) up to that many elements past the first one tested.
+	 */
+	constexpr size_t ORIENTATION_BATCH_SIZE = 16;
+
+	/**	Tests one segment against ORIENTATION_BATCH_SIZE consecutive segments of
+	 *	packed coordinate arrays.  The test is the one of Segment::intersects:
+	 *	bit k of the result is set iff segA.intersects(seg[first+k]) with
+	 *	segA = (ax1, ay1)-(ax2, ay2) and seg[j] = (x1[j], y1[j])-(x2[j], y2[j]),
+	 *	the endpoints being given in the p1_/p2_ order of the Segment objects.
+	 *	The determinants are evaluated in float with an error bound; the segments
+	 *	for which that is not enough to decide are tested with the exact predicate,
+	 *	so the results are those of the scalar test.
+	 *	Uses AVX-512, AVX, SSE, or NEON if the library is compiled for it, and
+	 *	plain scalar code otherwise.
+	 *	@param ax1	x coordinate of the first endpoint of the segment to test
+	 *	@param ay1	y coordinate of the first endpoint of the segment to test
+	 *	@param ax2	x coordinate of the second endpoint of the segment to test
+	 *	@param ay2	y coordinate of the second endpoint of the segment to test
+	 *	@param x1	x coordinates of the first endpoints, starting at the first segment tested
+	 *	@param y1	y coordinates of the first endpoints, starting at the first segment tested
+	 *	@param x2	x coordinates of the second endpoints, starting at the first segment tested
+	 *	@param y2	y coordinates of the second endpoints, starting at the first segment tested
+	 *	@param count	number of segments to actually test (at most ORIENTATION_BATCH_SIZE)
+	 *	@return a bitmask of the segments that intersect segA
+	 */
+	uint32_t intersectsBatch(float ax1, float ay1, float ax2, float ay2,
+							 const float* x1, const float* y1, const float* x2, const float* y2,
+							 size_t count);
+
+	/**	Name of the instruction set that intersectsBatch was compiled for
+	 *	("AVX-512", "AVX", "SSE", "NEON", or "scalar").
+	 */
+	const char* orientationKernelName(void);
+}
+
+#endif /* OrientationKernel_hpp */
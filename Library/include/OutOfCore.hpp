@@ -0,0 +1,61 @@
+//
+//  OutOfCore.hpp
+//
+//	Search of the intersections of a scene file too large to be loaded in memory.
+//	The segments are partitioned into horizontal strips stored in temporary files,
+//	and the strips are searched one at a time.
+//
+
+#ifndef OutOfCore_hpp
+#define OutOfCore_hpp
+
+#include <string>
+#include <cstddef>
+#include "SceneFile.hpp"
+
+namespace geometry {
+
+	struct OutOfCoreSettings{
+		/**	Memory (in bytes) that the search may use for the segments of a strip, the grid
+		 *	that searches them and the buffers of the temporary files
+		 */
+		size_t memoryBudget = size_t(256) << 20;
+		/**	Directory where the temporary files are created (empty: the system's temporary directory) */
+		std::string tempDirectory;
+		/**	Side of the cells of the grid search (0 means chosen for each strip) */
+		float cellSize = 0.f;
+	};
+
+	struct OutOfCoreStats{
+		size_t numSegments = 0;
+		size_t numIntersections = 0;
+		/**	Number of strips searched */
+		size_t numStrips = 0;
+		/**	Number of segments of the largest strip searched */
+		size_t maxStripSegments = 0;
+	};
+
+	/**	Finds all the intersections of the segments of a scene file, in memory bounded by
+	 *	settings.memoryBudget rather than by the size of the scene.  The segments are read
+	 *	by chunks, written to strip files, and each strip is searched with the grid search
+	 *	of findAllIntersectionsGrid.  A strip that doesn't fit in the budget is split again,
+	 *	unless the segments that span it take half of the budget, in which case it is searched as is.
+	 *
+	 *	As when the file is loaded in a scene, points are the same if they have exactly the same
+	 *	coordinates, and a segment listed again (between the same points, in either order) is
+	 *	only searched once.  The intersections are then those that findAllIntersectionsGrid finds
+	 *	in the scene, with bit-identical points, but segA < segB are the positions in the file of
+	 *	the first occurrences of the segments rather than their indices in the scene.
+	 *
+	 *	@param sceneFilePath	a scene file, in the text or binary format
+	 *	@param outFilePath	receives the intersections, as the intersection list of the text
+	 *					format (lines i <x> <y> <segA> <segB>), in no particular order
+	 *	@param stats	if not null, receives figures about the search
+	 *	@return OK, WRITE_FAILED (output or temporary files), or an error of the reading of the file
+	 */
+	SceneFileStatus findAllIntersectionsOutOfCore(const std::string& sceneFilePath, const std::string& outFilePath,
+												  const OutOfCoreSettings& settings, SceneFileError& error,
+												  OutOfCoreStats* stats = nullptr);
+}
+
+#endif /* OutOfCore_hpp */
@@ -9,9 +9,23 @@
 #define Point_hpp
 
 #include <memory>
-#include <set>
+#include <span>
+#include <vector>
+#include <cstdint>
 #include <cmath>
-#include "glPlatform.hpp"
+#include "SmallVector.hpp"
+
+/**	OpenGL rendering of the points and segments.  Builds for machines without a display
+ *	(the command-line tools, batch jobs) define GEOMETRY_RENDERING as 0, which removes
+ *	the render functions and the dependency on OpenGL and GLUT.
+ */
+#ifndef GEOMETRY_RENDERING
+	#define GEOMETRY_RENDERING 1
+#endif
+
+#if GEOMETRY_RENDERING
+	#include "glPlatform.hpp"
+#endif
 
 namespace geometry {
 
@@ -53,6 +67,32 @@ namespace geometry {
 			: x(theX), y(theY) {};
 	};
 
+	/**	Lightweight handle to a point of the registry: the point's index
+	 *	(Point::getIndex()).  Unlike a shared_ptr, a handle can be copied and passed
+	 *	around without touching a reference count, so inner loops should work on
+	 *	handles.  A handle is valid until the points are cleared.
+	 */
+	struct PointId{
+		unsigned int idx;
+
+		bool operator == (const PointId& ) const = default;
+	};
+
+	/**	Hash function for the 64-bit keys of our hash indices.  These keys pack
+	 *	two 32-bit values (grid cell coordinates, point indices) in a single word,
+	 *	so we mix the bits before handing them to an unordered_map.
+	 */
+	struct Key64Hash{
+		size_t operator()(uint64_t key) const{
+			key ^= key >> 33;
+			key *= 0xff51afd7ed558ccdULL;
+			key ^= key >> 33;
+			return static_cast<size_t>(key);
+		}
+	};
+
+	class Scene;
+
 	/**	Class created for passkey purposes (so that make_shared can make calls to
 	 *	a public constructor, but nobody else can.
 	 */
@@ -61,27 +101,32 @@ namespace geometry {
 			PointToken(void) {}
 		
 		friend class Point;
+		friend class Scene;
 	};
 
 
+	/**	A point of a Scene.  Points are created by (and belong to) a scene, which
+	 *	makes sure that there is only one point at a given location.  The static
+	 *	functions of this class work on the default scene (Scene::getDefault()).
+	 */
 	class Point{
 
 		friend class Segment;
+		friend class Scene;
         friend struct InterQueueEvent;
         
 		private:
 
 			float x_;
 			float y_;
-			// Seglist of all the segments these endpoints belong to
-			std::set<unsigned int> segList_;
+			/**	Seglist of all the segments these endpoints belong to, in increasing order of index.
+			 *	Most points are the endpoints of 1 to 4 segments, which fit in the object.
+			 */
+			SmallVector<unsigned int, 4> segList_;
 			unsigned int idx_;
+			Scene* scene_;
 
-			static unsigned int count_;
-            //The set of all points which are unique and can autosort itself
-			static std::set<std::shared_ptr<Point> > pointSet_;
-        
-			static std::vector<std::shared_ptr<Point> > pointVect_;
+#if GEOMETRY_RENDERING
 			static float pointDiskRadius_;
 			static GLuint diskList_;
 			static GLuint circleList_;
@@ -89,7 +134,7 @@ namespace geometry {
 			
 			
 			static void initDisplayLists_(void);
-			
+#endif
 
 		public:
 
@@ -99,9 +144,10 @@ namespace geometry {
 			Point& operator = (const Point& pt) = delete;
 			Point& operator = (Point&& pt) = delete;
 
-			Point(PointToken token, float xCoord, float yCoord);
-
-			~Point(void) = default;
+			/**	@param scene	the scene the point belongs to
+			 *	@param idx	the point's index in the scene
+			 */
+			Point(PointToken token, Scene& scene, unsigned int idx, float xCoord, float yCoord);
 
 			inline float getX(void) const{
 				return x_;
@@ -113,11 +159,21 @@ namespace geometry {
 			inline unsigned int getIndex(void) const{
 				return idx_;
 			}
-			
-			inline void setCoordinates(float x, float y){
-				x_ = x; y_ = y;
+
+			inline PointId getId(void) const{
+				return PointId{idx_};
+			}
+
+			inline Scene& getScene(void) const{
+				return *scene_;
 			}
 			
+			/**	Moves the point (and updates the spatial hash grid accordingly)
+			 *	@param x	the point's new x coordinate
+			 *	@param y	the point's new y coordinate
+			 */
+			void setCoordinates(float x, float y);
+			
 			bool isSingle(void) const{
 				return segList_.size() == 0;
 			}
@@ -125,23 +181,43 @@ namespace geometry {
 			size_t getConnectivityDegree(void) const{
 				return segList_.size();
 			}
-            std::set<unsigned int> getSegList(void) const{
-                return segList_;
-            }
+			/**	The indices of the segments this point is an endpoint of, in increasing order.
+			 *	The view is valid until a segment is added to or removed from the point.
+			 */
+			std::span<const unsigned int> getSegList(void) const{
+				return segList_.view();
+			}
+#if GEOMETRY_RENDERING
 			void render(PointType type = PointType::DEDUCED_TYPE) const;
 
 
 			static void render(const PointStruct& pt,
 							   PointType type = PointType::FIRST_ENDPOINT);
+#endif
+
 
+			//	The functions below work on the default scene.  @see Scene
 
 			static std::shared_ptr<Point> makeNewPointPtr(float xCoord,float yCoord);
 
 			static Point& makeNewPoint(float xCoord,float yCoord);
+
+			/**	Same as makeNewPointPtr, returning a handle to the point */
+			static PointId makeNewPointId(float xCoord, float yCoord);
+
+			/**	The point a handle refers to */
+			static const Point& getPoint(PointId id);
+
+			/**	The shared pointer to the point a handle refers to, for the functions
+			 *	that still take one
+			 */
+			static const std::shared_ptr<Point>& getPointPtr(PointId id);
+
+			/**	The coordinates of the point a handle refers to */
+			static PointStruct getCoordinates(PointId id);
 			
-			static const std::set<std::shared_ptr<Point> >& getAllPoints(void){
-				return pointSet_;
-			}
+			/**	All the points, in the order they were created (getIndex() is the position in the vector) */
+			static const std::vector<std::shared_ptr<Point> >& getAllPoints(void);
 //			static std::shared_ptr<Point> getPointAtIndex(size_t index);
 
 			static float distanceSq(float x1, float y1, float x2, float y2);
@@ -192,14 +268,23 @@ namespace geometry {
 				return (distanceSq(pt1.x, pt1.y, pt2.x, pt2.y) == 0.f);
 			}
 
-			static void clearAllPoints(void) {
-				pointSet_.clear();
-				count_ = 0;
-			}
+			/**	Removes all the points of the default scene.
+			 *	@see Scene::clearAllPoints
+			 */
+			static void clearAllPoints(void);
+
+			static unsigned long long getVersion(void);
+
+			/**	@see Scene::setGridCellSize */
+			static void setGridCellSize(float size);
+
+			static float getGridCellSize(void);
 
+#if GEOMETRY_RENDERING
 			static void setPointDiskRadius(float radius);
 
 			static void renderAllSinglePoints(void);
+#endif
 			
 	};
 //    // Compare struct that helps to compare between points, to decide their position in the queue
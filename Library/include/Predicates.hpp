@@ -0,0 +1,118 @@
+//
+//  Predicates.hpp
+//
+//	Robust orientation predicates for points with float coordinates.
+//
+
+#ifndef Predicates_hpp
+#define Predicates_hpp
+
+#include <cmath>
+#include "Counters.hpp"
+
+namespace geometry {
+
+	/**	Relative error bound of the double evaluation of an orientation determinant
+	 *	(Shewchuk's ccwerrboundA, for epsilon = 2^-53).
+	 */
+	constexpr double ORIENTATION_ERR_BOUND = (3.0 + 16.0 * 0x1p-53) * 0x1p-53;
+
+	/**	Relative error bound of the float evaluation of an orientation determinant
+	 *	(same bound, for epsilon = 2^-24).  Used by the batched kernel, together with
+	 *	an absolute term to cover underflow.
+	 */
+	constexpr float ORIENTATION_ERR_BOUND_FLOAT = static_cast<float>((3.0 + 16.0 * 0x1p-24) * 0x1p-24);
+
+	/**	Sign of det(p2 - p1, pt - p1) = (pt.x - p1.x)(p2.y - p1.y) - (p2.x - p1.x)(pt.y - p1.y),
+	 *	computed exactly.  Each product of two floats is exact in double, so the determinant
+	 *	is the exact sum of six doubles, whose sign we get from a floating-point expansion.
+	 *	@return 1, -1, or 0
+	 */
+	int orientationExact(float p1x, float p1y, float p2x, float p2y, float ptx, float pty);
+
+	/**	Sign of det(p2 - p1, pt - p1) (the determinant used by Segment::isOnLeftSide).
+	 *	The determinant is first evaluated in double.  Only if its magnitude is below the
+	 *	error bound of that evaluation (nearly collinear points) do we call orientationExact.
+	 *	@return 1, -1, or 0
+	 */
+	inline int orientation(float p1x, float p1y, float p2x, float p2y, float ptx, float pty){
+		GEOMETRY_COUNT(ORIENTATION_TESTS);
+		const double left = (static_cast<double>(ptx) - p1x) * (static_cast<double>(p2y) - p1y);
+		const double right = (static_cast<double>(p2x) - p1x) * (static_cast<double>(pty) - p1y);
+		const double det = left - right;
+		const double bound = ORIENTATION_ERR_BOUND * (std::fabs(left) + std::fabs(right));
+		//	computed without branching on the sign, which is unpredictable; the test below almost never fails
+		const int sign = static_cast<int>(det > bound) - static_cast<int>(det < -bound);
+		if (sign != 0){
+			return sign;
+		}
+		return orientationExact(p1x, p1y, p2x, p2y, ptx, pty);
+	}
+
+	/**	Relative error bound of the double evaluation of the determinant of lineOrder: each of its
+	 *	three terms is a product of three rounded differences, and two more roundings add them up.
+	 */
+	constexpr double LINE_ORDER_ERR_BOUND = (8.0 + 64.0 * 0x1p-53) * 0x1p-53;
+
+	/**	Compares where two lines cross the horizontal line of ordinate y.  Line k goes through
+	 *	its upper point (uxk, uyk) and its lower point (lxk, lyk), with uyk > lyk.  The difference
+	 *	of the abscissas of the crossings, multiplied by (uy1 - ly1)(uy2 - ly2) > 0, is
+	 *		(ux1 - ux2)(uy1 - ly1)(uy2 - ly2) + (uy1 - y)(lx1 - ux1)(uy2 - ly2) - (uy2 - y)(lx2 - ux2)(uy1 - ly1)
+	 *	a sum of sixteen products of three coordinates, whose sign we get from an expansion.
+	 *	@return 1 if line 1 crosses to the right of line 2, -1 if to the left, 0 at the same point
+	 */
+	int lineOrderExact(float ux1, float uy1, float lx1, float ly1, float ux2, float uy2, float lx2, float ly2, float y);
+
+	/**	Same as lineOrderExact, evaluated in double first like orientation
+	 */
+	inline int lineOrder(float ux1, float uy1, float lx1, float ly1, float ux2, float uy2, float lx2, float ly2, float y){
+		const double dy1 = static_cast<double>(uy1) - ly1;
+		const double dy2 = static_cast<double>(uy2) - ly2;
+		const double term1 = (static_cast<double>(ux1) - ux2) * dy1 * dy2;
+		const double term2 = (static_cast<double>(uy1) - y) * (static_cast<double>(lx1) - ux1) * dy2;
+		const double term3 = (static_cast<double>(uy2) - y) * (static_cast<double>(lx2) - ux2) * dy1;
+		const double det = term1 + term2 - term3;
+		const double bound = LINE_ORDER_ERR_BOUND * (std::fabs(term1) + std::fabs(term2) + std::fabs(term3));
+		if (det > bound){
+			return 1;
+		}
+		if (det < -bound){
+			return -1;
+		}
+		return lineOrderExact(ux1, uy1, lx1, ly1, ux2, uy2, lx2, ly2, y);
+	}
+
+	/**	Compares the directions of two segments going down from their upper points, i.e. the
+	 *	signs of (lx1 - ux1)/(uy1 - ly1) - (lx2 - ux2)/(uy2 - ly2), computed exactly as the sign of
+	 *	(lx1 - ux1)(uy2 - ly2) - (lx2 - ux2)(uy1 - ly1).  Both segments must go down (uyk > lyk).
+	 *	@return 1 if segment 1 goes more to the right than segment 2, -1 if less, 0 if parallel
+	 */
+	int slopeOrderExact(float ux1, float uy1, float lx1, float ly1, float ux2, float uy2, float lx2, float ly2);
+
+	/**	Same as slopeOrderExact, evaluated in double first like orientation (the determinant has
+	 *	the same form, so the same error bound)
+	 */
+	inline int slopeOrder(float ux1, float uy1, float lx1, float ly1, float ux2, float uy2, float lx2, float ly2){
+		const double left = (static_cast<double>(lx1) - ux1) * (static_cast<double>(uy2) - ly2);
+		const double right = (static_cast<double>(lx2) - ux2) * (static_cast<double>(uy1) - ly1);
+		const double det = left - right;
+		const double bound = ORIENTATION_ERR_BOUND * (std::fabs(left) + std::fabs(right));
+		if (det > bound){
+			return 1;
+		}
+		if (det < -bound){
+			return -1;
+		}
+		return slopeOrderExact(ux1, uy1, lx1, ly1, ux2, uy2, lx2, ly2);
+	}
+
+	/**	The determinant of orientation, evaluated in plain float arithmetic.  This is what
+	 *	Segment::isOnLeftSide used to test, and is kept for comparison and benchmarking:
+	 *	its sign is unreliable for nearly collinear points.
+	 */
+	inline float orientationDetFloat(float p1x, float p1y, float p2x, float p2y, float ptx, float pty){
+		return ((ptx - p1x) * (p2y - p1y)) - ((p2x - p1x) * (pty - p1y));
+	}
+}
+
+#endif /* Predicates_hpp */
@@ -0,0 +1,311 @@
+//
+//  Scene.hpp
+//
+//	A scene owns a set of points and the segments that join them, with the
+//	indices used to find them and the data derived from them.  Scenes share no
+//	state, so several of them can be built and searched at the same time, one
+//	per thread.  The static functions of Point and Segment work on the default
+//	scene.
+//
+
+#ifndef Scene_hpp
+#define Scene_hpp
+
+#include <memory>
+#include <vector>
+#include <span>
+#include <utility>
+#include <unordered_map>
+#include <cstdint>
+#include "Arena.hpp"
+#include "Point.hpp"
+#include "Segment.hpp"
+
+namespace geometry {
+
+	class SegmentHashGrid;
+	class SegmentSoA;
+
+	class Scene{
+
+		friend class Point;
+		friend class ConcurrentRegistry;
+
+		private:
+
+			/**	All the points (which are unique), pointVect_[k] being the point of index k
+			 */
+			std::vector<std::shared_ptr<Point> > pointVect_;
+			/**	The arena that the points are allocated in.  Replaced by a new one when
+			 *	the points are cleared: the old one goes away with its last point.
+			 */
+			std::shared_ptr<Arena> pointArena_;
+			/**	Spatial hash grid kept alongside pointVect_: each cell of side
+			 *	gridCellSize_ lists the indices of the points that fall in it, so that
+			 *	looking for an existing point only requires to check its own cell.
+			 *	Its nodes are allocated in pointArena_ (the memory of the entries removed
+			 *	when a point moves is only reclaimed when the points are cleared).
+			 */
+			using PointGrid_ = std::unordered_multimap<uint64_t, unsigned int, Key64Hash, std::equal_to<uint64_t>,
+													   ArenaAllocator<std::pair<const uint64_t, unsigned int> > >;
+			PointGrid_ pointGrid_;
+			float gridCellSize_;
+			/**	Incremented each time a point is moved or the points are cleared,
+			 *	so that data computed from the coordinates of the points (e.g. a
+			 *	SegmentSoA snapshot) can tell that it is out of date.
+			 */
+			unsigned long long pointVersion_;
+
+			/**	All the segments, segVect_[k] being the segment of index k
+			 */
+			std::vector<std::shared_ptr<Segment> > segVect_;
+			/**	The arena that the segments are allocated in
+			 *	@see pointArena_
+			 */
+			std::shared_ptr<Arena> segArena_;
+			/**	Hash index of the segments in segVect_, keyed on the (unordered)
+			 *	pair of indices of their endpoints.  Its nodes are allocated in segArena_.
+			 *	@see endpointKey_
+			 */
+			using SegIndex_ = std::unordered_map<uint64_t, unsigned int, Key64Hash, std::equal_to<uint64_t>,
+												 ArenaAllocator<std::pair<const uint64_t, unsigned int> > >;
+			SegIndex_ segIndex_;
+			/**	Incremented each time a segment is added or the segments are cleared
+			 *	@see pointVersion_
+			 */
+			unsigned long long segVersion_;
+
+			/**	Incrementally maintained intersections (see setIncrementalIntersections):
+			 *	the intersections of all the segments, a grid index of the segments,
+			 *	and the version of the points the intersections were computed for.
+			 */
+			bool incremental_;
+			std::vector<IntersectionRecord> liveIntersections_;
+			std::unique_ptr<SegmentHashGrid> liveIndex_;
+			unsigned long long livePointVersion_;
+			float indexCellSize_;
+
+			/**	Snapshot of segVect_, and the versions of the segments and points it was built from
+			 *	@see getSnapshot
+			 */
+			std::shared_ptr<const SegmentSoA> snapshot_;
+			unsigned long long snapshotSegVersion_;
+			unsigned long long snapshotPointVersion_;
+
+			/**	Integer coordinate of the grid cell containing a coordinate value.
+			 *	Clamped so that silly coordinates can't overflow the cell index.
+			 */
+			int32_t gridCell_(float v) const;
+
+			/**	Packs the integer coordinates of a grid cell into a hash key */
+			inline static uint64_t gridKey_(int32_t i, int32_t j){
+				return (static_cast<uint64_t>(static_cast<uint32_t>(i)) << 32) |
+						static_cast<uint64_t>(static_cast<uint32_t>(j));
+			}
+
+			/**	Key of a segment in segIndex_: the indices of its endpoints, smaller one first
+			 */
+			inline static uint64_t endpointKey_(unsigned int idx1, unsigned int idx2){
+				return idx1 < idx2 ?
+						(static_cast<uint64_t>(idx1) << 32) | idx2 :
+						(static_cast<uint64_t>(idx2) << 32) | idx1;
+			}
+
+			/**	Looks for a point with exactly the coordinates passed.
+			 *	@return the index of the existing point, UINT_MAX if there is none
+			 */
+			unsigned int findPoint_(float xCoord, float yCoord) const;
+
+			/**	Index of the point at the coordinates passed, created if there was none */
+			unsigned int findOrAddPoint_(float xCoord, float yCoord);
+
+			/**	Creates a point of the scene in an arena (but doesn't register it) */
+			std::shared_ptr<Point> newPoint_(const std::shared_ptr<Arena>& arena, unsigned int idx,
+											 float xCoord, float yCoord);
+
+			/**	Adds a point to the spatial hash grid */
+			void addToGrid_(const Point& pt);
+
+			/**	Moves a point of the scene (and updates the spatial hash grid accordingly)
+			 *	@see Point::setCoordinates
+			 */
+			void movePoint_(Point& pt, float x, float y);
+
+			/**	Index of the segment joining two points, created if there was none */
+			unsigned int findOrAddSegment_(const std::shared_ptr<Point>& pt1, const std::shared_ptr<Point>& pt2);
+
+			/**	Creates a segment of the scene in an arena (but doesn't register it) */
+			static std::shared_ptr<Segment> newSegment_(const std::shared_ptr<Arena>& arena, unsigned int idx,
+														const std::shared_ptr<Point>& pt1, const std::shared_ptr<Point>& pt2);
+
+			/**	Recomputes the live intersections and their index from scratch */
+			void rebuildLiveIntersections_(void);
+
+			/**	Adds the intersections of a new segment to the live intersections,
+			 *	then adds the segment to the index
+			 */
+			void addLiveIntersections_(const Segment& seg);
+
+		public:
+
+			Scene(void);
+
+			/**	Clears the scene.  Points and segments of the scene that are still
+			 *	referenced elsewhere may only be destroyed after that.
+			 */
+			~Scene(void);
+
+			//	Disabled constructors and operators.  Points and segments refer to their scene.
+			Scene(const Scene& ) = delete;
+			Scene(Scene&& ) = delete;
+			Scene& operator = (const Scene& ) = delete;
+			Scene& operator = (Scene&& ) = delete;
+
+			/**	The scene that the static functions of Point and Segment work on */
+			static Scene& getDefault(void);
+
+			//	Points
+
+			/**	Returns the point at the coordinates passed, created if the scene had
+			 *	no point with exactly these coordinates
+			 */
+			std::shared_ptr<Point> makeNewPointPtr(float xCoord, float yCoord);
+
+			Point& makeNewPoint(float xCoord, float yCoord);
+
+			/**	Same as makeNewPointPtr, returning a handle to the point */
+			PointId makeNewPointId(float xCoord, float yCoord);
+
+			/**	Bulk version of makeNewPointId, which makes room for all the points up front
+			 *	@param coords	the coordinates of the points
+			 *	@param ids	receives the handles of the points (appended), in the order of coords
+			 */
+			void makeNewPointIds(std::span<const PointStruct> coords, std::vector<PointId>& ids);
+
+			/**	The point a handle refers to */
+			inline const Point& getPoint(PointId id) const{
+				return *pointVect_[id.idx];
+			}
+
+			/**	The shared pointer to the point a handle refers to, for the functions
+			 *	that still take one
+			 */
+			inline const std::shared_ptr<Point>& getPointPtr(PointId id) const{
+				return pointVect_[id.idx];
+			}
+
+			/**	The coordinates of the point a handle refers to */
+			inline PointStruct getCoordinates(PointId id) const{
+				const Point& pt = *pointVect_[id.idx];
+				return PointStruct(pt.x_, pt.y_);
+			}
+
+			/**	All the points, in the order they were created (getIndex() is the position in the vector) */
+			inline const std::vector<std::shared_ptr<Point> >& getAllPoints(void) const{
+				return pointVect_;
+			}
+
+			/**	Removes all the points.  Each point is still released one by one (its
+			 *	destructor runs when its last shared_ptr goes), so this is O(n); what is
+			 *	saved is freeing the memory, which the arena returns in a few chunks once
+			 *	no point allocated from it is held anymore.
+			 */
+			void clearAllPoints(void);
+
+			inline unsigned long long getPointVersion(void) const{
+				return pointVersion_;
+			}
+
+			/**	Sets the side length of the cells of the spatial hash grid used to
+			 *	detect duplicate points, and redistributes the existing points in
+			 *	the new grid.  The cell size should be small enough that a cell
+			 *	only holds a handful of points.
+			 *	@param size side length of a grid cell, in world units
+			 */
+			void setGridCellSize(float size);
+
+			inline float getGridCellSize(void) const{
+				return gridCellSize_;
+			}
+
+			//	Segments
+
+			/**	Returns the segment joining two points of the scene, created if there was none
+			 *	(in either direction)
+			 */
+			std::shared_ptr<Segment> makeNewSegPtr(const std::shared_ptr<Point>& pt1, const std::shared_ptr<Point>& pt2);
+
+			Segment& makeNewSeg(const std::shared_ptr<Point>& pt1, const std::shared_ptr<Point>& pt2);
+
+			/**	Same as makeNewSegPtr, from and to handles */
+			SegmentId makeNewSegId(PointId pt1, PointId pt2);
+
+			/**	Bulk version of makeNewSegId, which makes room for all the segments up front.
+			 *	If the intersections are maintained incrementally, they are recomputed once at the end.
+			 *	@param ends	the segments, as pairs of positions in points
+			 *	@param points	handles of points of the scene
+			 */
+			void makeNewSegIds(std::span<const std::pair<unsigned int, unsigned int> > ends,
+							   std::span<const PointId> points);
+
+			/**	The segment a handle refers to */
+			inline const Segment& getSegment(SegmentId id) const{
+				return *segVect_[id.idx];
+			}
+
+			/**	The shared pointer to the segment a handle refers to, for the functions
+			 *	that still take one
+			 */
+			inline const std::shared_ptr<Segment>& getSegmentPtr(SegmentId id) const{
+				return segVect_[id.idx];
+			}
+
+			/**	All the segments, in the order they were created (getIndex() is the position in the vector) */
+			inline const std::vector<std::shared_ptr<Segment> >& getAllSegments(void) const{
+				return segVect_;
+			}
+
+			/**	Removes all the segments.  As for clearAllPoints, the segments are still
+			 *	released one by one (O(n)), but their memory is freed in a few chunks.
+			 */
+			void clearAllSegments(void);
+
+			inline unsigned long long getSegmentVersion(void) const{
+				return segVersion_;
+			}
+
+			/**	Packed snapshot of all the segments.  It is only rebuilt when segments
+			 *	were added or cleared, or points were moved, since the last call.  The
+			 *	snapshot returned is not modified by later changes to the scene.
+			 */
+			std::shared_ptr<const SegmentSoA> getSnapshot(void);
+
+			//	Incremental intersections
+
+			/**	Turns on/off the incremental maintenance of the intersections of all the
+			 *	segments.  When it is on, makeNewSegPtr only tests the new segment against
+			 *	the segments that share a grid cell with it and adds the intersections found
+			 *	to the live set, so that getLiveIntersections is always up to date.
+			 *	@param on	true to maintain the intersections, false to drop them
+			 */
+			void setIncrementalIntersections(bool on);
+
+			inline bool getIncrementalIntersections(void) const{
+				return incremental_;
+			}
+
+			/**	The intersections of all the segments, if incremental maintenance is on
+			 *	(empty otherwise).  If points were moved since the last update, the
+			 *	intersections are recomputed from scratch.
+			 */
+			const std::vector<IntersectionRecord>& getLiveIntersections(void);
+
+			/**	Sets the side of the cells of the grid that indexes the segments for the
+			 *	incremental maintenance of intersections.  It should be about the length of a
+			 *	typical segment.
+			 */
+			void setIndexCellSize(float size);
+	};
+}
+
+#endif /* Scene_hpp */
@@ -0,0 +1,216 @@
+//
+//  SceneFile.hpp
+//
+//	Reading of scene data files:
+//		- world bounds: the four lines XMIN = <float>, XMAX = ..., YMIN = ..., YMAX = ...
+//		- point list: lines p|v <float> <float>
+//		- segment list: lines s <point index> <point index>
+//		- optionally, the intersections of the segments: lines i <float> <float> <segment index> <segment index>
+//	Blank lines and lines whose first non-blank character is # are skipped.  The
+//	first line that doesn't belong to the current section ends it, and the file
+//	ends with the intersection list.
+//
+//	The same data can be stored in a binary scene file (see BinarySceneHeader),
+//	which is memory-mapped and used in place.
+//
+
+#ifndef SceneFile_hpp
+#define SceneFile_hpp
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <span>
+#include <memory>
+#include <cstdint>
+#include "Point.hpp"
+#include "Segment.hpp"
+#include "MappedFile.hpp"
+
+namespace geometry {
+
+	class Scene;
+	class BufferedWriter;
+
+	/**	Outcome of the reading of a scene file.  The nonzero values are the exit
+	 *	codes that the demo application has always used for these errors.
+	 */
+	enum class SceneFileStatus{
+		OK = 0,
+		FILE_NOT_FOUND = 7,
+		INVALID_RECORD = 8,
+		INVALID_WORLD_BOUND = 9,
+		INVALID_BINARY_FILE = 10,
+		WRITE_FAILED = 11
+	};
+
+	/**	The contents of a scene file
+	 */
+	struct SceneFileData{
+		float xmin = 0.f, xmax = 0.f, ymin = 0.f, ymax = 0.f;
+		std::vector<PointStruct> points;
+		/**	The segments, as pairs of positions in points */
+		std::vector<std::pair<unsigned int, unsigned int> > segments;
+		/**	The intersections of the segments, if they were saved (segA and segB are positions in segments) */
+		std::vector<IntersectionRecord> intersections;
+	};
+
+	/**	Why and where the reading of a scene file failed
+	 */
+	struct SceneFileError{
+		SceneFileStatus status = SceneFileStatus::OK;
+		/**	Number (from 1) of the line at fault, 0 if the error is not about a line */
+		size_t lineNumber = 0;
+		/**	Message that can be shown to the user as is */
+		std::string message;
+	};
+
+	/**	Parses the text of a scene file.  A large text is split in line-aligned chunks that
+	 *	are parsed by several threads, with the same result as a single thread.
+	 *	@param text	the contents of the file
+	 *	@param data	receives the contents of the file (appended to its lists)
+	 *	@param error	receives the details of the error, if any
+	 *	@param numThreads	number of threads to use (0 means one per hardware thread)
+	 *	@return OK, INVALID_RECORD or INVALID_WORLD_BOUND
+	 */
+	SceneFileStatus parseSceneFile(std::string_view text, SceneFileData& data, SceneFileError& error,
+								   unsigned int numThreads = 0);
+
+	/**	Reads a scene file.  The file is memory-mapped rather than read through a stream.
+	 *	@see parseSceneFile
+	 */
+	SceneFileStatus readSceneFile(const std::string& filePath, SceneFileData& data, SceneFileError& error,
+								  unsigned int numThreads = 0);
+
+	/**	Receiver of the records of a scene file read by streamSceneFile, in file order
+	 */
+	class SceneFileHandler{
+
+		public:
+
+			virtual ~SceneFileHandler(void) = default;
+
+			virtual void setWorldBounds(float xmin, float xmax, float ymin, float ymax) = 0;
+
+			virtual void addPoint(float x, float y) = 0;
+
+			/**	@param index1, index2	positions of the endpoints among the points of the file */
+			virtual void addSegment(unsigned int index1, unsigned int index2) = 0;
+
+			/**	segA and segB are positions among the segments of the file.  Ignored by default. */
+			virtual void addIntersection(const IntersectionRecord& ){}
+	};
+
+	/**	Reads a text scene file by chunks, and hands its records to a handler as they
+	 *	are parsed, so that files larger than memory can be processed.
+	 *	@see parseSceneFile
+	 */
+	SceneFileStatus streamSceneFile(const std::string& filePath, SceneFileHandler& handler, SceneFileError& error);
+
+	/**	Writes a scene file in the text format.  The coordinates are written with the
+	 *	fewest digits that read back as the same float.
+	 *	@return OK or WRITE_FAILED
+	 */
+	SceneFileStatus writeSceneFile(const std::string& filePath, const SceneFileData& data, SceneFileError& error);
+
+	/**	Writes a line of the intersection list of the text format */
+	void writeIntersectionLine(BufferedWriter& writer, const IntersectionRecord& inter);
+
+	/**	Copies the points and segments of a scene (appended to the lists of data).
+	 *	The positions of the points and segments in the lists are their indices in the scene.
+	 */
+	void copyFromScene(const Scene& scene, SceneFileData& data);
+
+	/**	Header of a binary scene file.  All the values are little-endian.  The header
+	 *	is followed by the points (x and y as floats) at pointsOffset, and the segments
+	 *	(pairs of uint32 indices of points) at segmentsOffset.  Both offsets are multiples
+	 *	of 64, so that once the file is mapped, the arrays can be used in place.
+	 */
+	struct BinarySceneHeader{
+		char magic[8];
+		uint32_t version;
+		/**	Size of the header, for versions that add fields at the end */
+		uint32_t headerSize;
+		float xmin, xmax, ymin, ymax;
+		uint64_t numPoints;
+		uint64_t numSegments;
+		uint64_t pointsOffset;
+		uint64_t segmentsOffset;
+
+		static constexpr char MAGIC[8] = {'S', 'E', 'G', 'S', 'C', 'E', 'N', 'E'};
+		static constexpr uint32_t VERSION = 1;
+		static constexpr uint64_t ALIGNMENT = 64;
+	};
+
+	/**	A binary scene file, mapped in memory.  The points and segments are read from
+	 *	disk as they are accessed, and are valid as long as the object exists.
+	 */
+	class BinarySceneFile{
+
+		private:
+
+			std::unique_ptr<MappedFile> file_;
+			BinarySceneHeader header_;
+			std::span<const PointStruct> points_;
+			std::span<const std::pair<unsigned int, unsigned int> > segments_;
+
+		public:
+
+			BinarySceneFile(void);
+
+			/**	Maps a binary scene file and checks it (including the indices of the segments).
+			 *	@return OK, FILE_NOT_FOUND or INVALID_BINARY_FILE
+			 */
+			SceneFileStatus open(const std::string& filePath, SceneFileError& error);
+
+			inline float getXmin(void) const{
+				return header_.xmin;
+			}
+			inline float getXmax(void) const{
+				return header_.xmax;
+			}
+			inline float getYmin(void) const{
+				return header_.ymin;
+			}
+			inline float getYmax(void) const{
+				return header_.ymax;
+			}
+
+			inline std::span<const PointStruct> getPoints(void) const{
+				return points_;
+			}
+
+			/**	The segments, as pairs of positions in getPoints() */
+			inline std::span<const std::pair<unsigned int, unsigned int> > getSegments(void) const{
+				return segments_;
+			}
+
+			/**	Copies the contents of the file (appended to the lists of data) */
+			void copyTo(SceneFileData& data) const;
+	};
+
+	/**	Writes a scene file in the binary format.  The intersections are not saved.
+	 *	@return OK or WRITE_FAILED
+	 */
+	SceneFileStatus writeBinarySceneFile(const std::string& filePath, const SceneFileData& data, SceneFileError& error);
+
+	/**	@return true if the file exists and starts like a binary scene file */
+	bool isBinarySceneFile(const std::string& filePath);
+
+	/**	Converts a scene file from the text format to the binary one, or the other way around
+	 *	@param inFilePath	the file to convert, in either format
+	 *	@param outFilePath	the converted file
+	 */
+	SceneFileStatus convertSceneFile(const std::string& inFilePath, const std::string& outFilePath,
+									 SceneFileError& error);
+
+	/**	Adds the points and segments of a scene file to a scene, in bulk
+	 *	@see Scene::makeNewPointIds
+	 */
+	void addToScene(const SceneFileData& data, Scene& scene);
+
+	void addToScene(const BinarySceneFile& file, Scene& scene);
+}
+
+#endif /* SceneFile_hpp */
@@ -0,0 +1,87 @@
+//
+//  SceneGenerator.hpp
+//
+//	Generation of random scenes, reproducible from a seed, with a chosen number of
+//	segments and of crossings, to benchmark the searches at any scale.
+//
+
+#ifndef SceneGenerator_hpp
+#define SceneGenerator_hpp
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "SceneFile.hpp"
+
+namespace geometry {
+
+	/**	How the segments of a generated scene are laid out.  Each distribution places its
+	 *	segments around centers that don't depend on the scale of the scene, and the scale
+	 *	stretches the segments around these centers, which sets the number of crossings.
+	 */
+	enum class SceneDistribution{
+		/**	both endpoints uniform in the world */
+		UNIFORM,
+		/**	short segments of random directions, of about the distance between neighbors */
+		SHORT,
+		/**	chords joining two sides of the world, which all cross many others */
+		LONG,
+		/**	horizontal and vertical segments on evenly spaced lines */
+		GRID,
+		/**	groups of segments that share endpoints, overlap on a common line, or end on another
+		 *	segment, with exact coordinates so that the degeneracies are not lost to rounding
+		 */
+		DEGENERATE
+	};
+
+	struct SceneGeneratorSettings{
+		/**	Value of targetCrossings that leaves the scene at its natural scale */
+		static constexpr size_t NO_TARGET = SIZE_MAX;
+
+		SceneDistribution distribution = SceneDistribution::SHORT;
+		size_t numSegments = 1000;
+		/**	Side of the square world, with its lower left corner at the origin */
+		float worldSize = 1000.f;
+		uint64_t seed = 1;
+		/**	Number of crossings (pairs of segments whose interiors cross, as the searches count
+		 *	them) that the scene is scaled to have, or NO_TARGET
+		 */
+		size_t targetCrossings = NO_TARGET;
+		/**	Relative difference to targetCrossings at which the scaling stops */
+		double tolerance = 0.01;
+		/**	Whether to count the crossings of a scene generated without target.  Counting
+		 *	takes the time of a grid search, which is quadratic for UNIFORM and LONG.
+		 */
+		bool countCrossings = false;
+	};
+
+	struct SceneGeneratorStats{
+		/**	Number of crossings of the scene, if they were counted */
+		size_t numCrossings = 0;
+		bool crossingsCounted = false;
+		/**	Scale the segments were stretched by (1 is the natural scale of the distribution) */
+		double scale = 1.0;
+		/**	Number of scenes generated to reach the target */
+		unsigned int numTrials = 0;
+	};
+
+	/**	Generates a scene.  The same settings always give the same scene.  With a target, the
+	 *	scale is searched by bisection (the crossings only grow with the scale, except for
+	 *	rounding), so the generation takes a few grid searches; a target that no scale reaches,
+	 *	such as more crossings than pairs of segments, gives the closest scene found.
+	 *	@param data	receives the scene (its former contents are discarded)
+	 *	@param stats	if not null, receives the number of crossings and the scale of the scene
+	 */
+	void generateScene(const SceneGeneratorSettings& settings, SceneFileData& data, SceneGeneratorStats* stats = nullptr);
+
+	/**	@return the number of crossings of the segments of a scene, found by the grid search */
+	size_t countCrossings(const SceneFileData& data);
+
+	/**	@return the name of a distribution in the tools' options ("uniform", "short", ...) */
+	const char* getDistributionName(SceneDistribution distribution);
+
+	/**	@return false if name is not the name of a distribution */
+	bool parseDistributionName(const std::string& name, SceneDistribution& distribution);
+}
+
+#endif /* SceneGenerator_hpp */
@@ -13,10 +13,14 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <unordered_map>
+#include <functional>
 #include "Point.hpp"
 
 namespace geometry {
 
+	class SegmentSoA;
+
 	/** Enum type only used for rendering.
 	 */
 	enum class SegmentType{
@@ -32,6 +36,7 @@ namespace geometry {
 		private:
 			SegmentToken() {}
 		friend class Segment;
+		friend class Scene;
 	};
 
     /** Struct used to sort the points of a "potential Segment," by which
@@ -55,17 +60,43 @@ namespace geometry {
 		friend class Segment;
 	};
 	
+	/**	An intersection found by the findAllIntersections* functions: its location, and the
+	 *	indices (Segment::getIndex()) of the two segments that intersect there.
+	 *	The versions of these functions that fill a vector of IntersectionRecord don't allocate
+	 *	anything per intersection, and the vector can be reused from one call to the next.
+	 */
+	struct IntersectionRecord{
+		float x;
+		float y;
+		unsigned int segA;
+		unsigned int segB;
+	};
+
+	/**	Lightweight handle to a segment of the registry: the segment's index
+	 *	(Segment::getIndex()).
+	 *	@see PointId
+	 */
+	struct SegmentId{
+		unsigned int idx;
+
+		bool operator == (const SegmentId& ) const = default;
+	};
+
+	struct compareSegment;
+
+	/**	A segment of a Scene, joining two points of the scene.  The static functions
+	 *	of this class work on the default scene (Scene::getDefault()).
+	 */
 	class Segment{
 
+		friend struct compareSegment;
+		friend class Scene;
+
 		private:
 
             std::shared_ptr<Point> p1_;
             std::shared_ptr<Point> p2_;
 			unsigned int idx_;
-						
-			static std::set<std::shared_ptr<Segment> > segSet_;
-			static std::vector<std::shared_ptr<Segment> > segVect_;
-			static unsigned int count_;
 
 			Segment(std::shared_ptr<Point> pt1, std::shared_ptr<Point> pt2);
 
@@ -76,54 +107,78 @@ namespace geometry {
 			Segment& operator = (const Segment& ) = delete;
 			Segment& operator = (Segment&& ) = delete;
 
+#if GEOMETRY_RENDERING
 			static void render_(const Point& pt1, const Point& pt2, SegmentType type);
+#endif
 			
 		public:
 		
-        Segment(SegmentToken token, std::shared_ptr<Point> pt1, std::shared_ptr<Point> pt2);
+			/**	@param idx	the segment's index in the scene of its endpoints
+			 */
+        Segment(SegmentToken token, unsigned int idx, std::shared_ptr<Point> pt1, std::shared_ptr<Point> pt2);
  
         ~Segment(void);
 
 			inline unsigned int getIndex(void) const {
 				return idx_;
 			}
-            inline const std::shared_ptr<Point> getP1(void) const {
+			/**	Handle to the segment (only meaningful for a segment of the registry) */
+			inline SegmentId getId(void) const {
+				return SegmentId{idx_};
+			}
+            inline const std::shared_ptr<Point>& getP1(void) const {
                 return p1_;
             }
-            inline const std::shared_ptr<Point> getP2(void) const {
+            inline const std::shared_ptr<Point>& getP2(void) const {
                 return p2_;
             }
-            //The vector of segments with which this segment has swapped
-            std::vector<int> swappedSegs;
-            //The vector of segments with which this segment has done a comparison
-            std::vector<int> comparedSegs;
+			inline PointId getP1Id(void) const {
+				return PointId{p1_->idx_};
+			}
+			inline PointId getP2Id(void) const {
+				return PointId{p2_->idx_};
+			}
+			/**	The scene of the segment's endpoints */
+			inline Scene& getScene(void) const {
+				return *p1_->scene_;
+			}
 			
+#if GEOMETRY_RENDERING
 			void render(SegmentType type = SegmentType::SEGMENT) const;
+#endif
 
-			bool isOnLeftSide(const std::shared_ptr<Point> pt) const;
+			bool isOnLeftSide(const std::shared_ptr<Point>& pt) const;
             /**Function that checks if the point is on left of the segments or not
              *@param pt - a reference to a constant point struct which has to be checked on its direction to the segment
              *@return boolean that tells if the point is on left or not
              */
 			bool isOnLeftSide(const PointStruct& pt) const;
 
-			/**Function that checks the points of the intersecting segment if they are on opposite sides which will set the basis of intersection
+			/**	@param pt - a point of the scene of this segment
+			 *	@see isOnLeftSide(const PointStruct&)
+			 */
+			bool isOnLeftSide(PointId pt) const;
+
+			/**Function that checks the points of the intersecting segment if they are on opposite sides which will set the basis of intersection.
+			 * A point that lies on the line of the segment is on neither side.
 			 *@param pt1 - a reference to a constant point 1 which has to be checked on its direction to the segment
 			 *@param pt2 - a reference to a constant point 2 which has to be checked on its direction to the segment
-			 *@return boolean that tells if the 2 points are on the opposite sides of the currSeg
+			 *@return boolean that tells if the 2 points are strictly on the opposite sides of the currSeg
 			 */
-			bool areOnOppositeSides(const std::shared_ptr<Point> pt1, const std::shared_ptr<Point> pt2) const;
+			bool areOnOppositeSides(const std::shared_ptr<Point>& pt1, const std::shared_ptr<Point>& pt2) const;
 
 			/**Function that checks the points of the intersecting segment if they are on opposite sides which will set the basis of intersection
 			 *@param pt1 - a reference to a constant point 1 struct which has to be checked on its direction to the segment
 			 *@param pt2 - a reference to a constant point 2 struct which has to be checked on its direction to the segment
-			 *@return boolean that tells if the 2 points are on the opposite sides of the currSeg
+			 *@return boolean that tells if the 2 points are strictly on the opposite sides of the currSeg
 			 */
 			bool areOnOppositeSides(const PointStruct& pt1, const PointStruct& pt2) const;
         
 			/**Intersection possible iff:
 			 *  Seg1.pt1 and seg1.pt2 are on different sides of Seg2
 			 *  Seg2.pt1 and seg2.pt2 are on different sides of Seg1
+			 * So only proper crossings count: segments that share an endpoint, that touch at an
+			 * endpoint (T junction), or that overlap along a common line don't intersect.
 			 *@param seg - the segment which is possible of intersection
 			 *@return boolean that tells if the intersection exists between two segments
 			 */
@@ -134,7 +189,7 @@ namespace geometry {
 			 *@param pt2 - a const reference to another point - part of a possibly intersecting segment
 			 *@return boolean that tells if the intersection exists between two segments
 			 */
-			bool intersects(const std::shared_ptr<Point> pt1, const std::shared_ptr<Point> pt2) const;
+			bool intersects(const std::shared_ptr<Point>& pt1, const std::shared_ptr<Point>& pt2) const;
 
 			/**
 			 *@param pt1 - a const reference to pointStruct  - part of a possibly intersecting segment
@@ -143,51 +198,165 @@ namespace geometry {
 			 */
 			bool intersects(const PointStruct& pt1, const PointStruct& pt2) const;
 
+			/**
+			 *@param seg - handle to a segment of this segment's scene
+			 *@return boolean that tells if the intersection exists between two segments
+			 */
+			bool intersects(SegmentId seg) const;
+
 			/**Function that checks interSeg with the currSeg to see if there is an intersection, if there is pointer to the intersection pt is returned                            otherwise a null pointer is returned
 			 *@param interSeg A const reference to a segment which is possible candidate of an intersection
 			 *@return A pointer to Point struct variable which is the intersection point of both segments
 			 */
             std::unique_ptr<PointStruct> findIntersection(const Segment& interSeg);
+
+			/**Same as above, without allocating the intersection point
+			 *@param interSeg A const reference to a segment which is possible candidate of an intersection
+			 *@param interPt	set to the intersection point of both segments, if there is one
+			 *@return true if the segments intersect
+			 */
+			bool findIntersection(const Segment& interSeg, PointStruct& interPt) const;
+
+			bool findIntersection(SegmentId interSeg, PointStruct& interPt) const;
+
+			//	The functions below work on the default scene.  @see Scene
+
             /**Maker function for the segment that will create a shared pointer to the segment so it can be stored in the set
              * @param pt1 a reference to a point 1 which will be used to create a segment
              * @param pt2 a reference to a point 2 which will be used to create a segment
              * @return a shared pointer to the segment
              */
-            static std::shared_ptr<Segment> makeNewSegPtr(std::shared_ptr<Point> pt1, std::shared_ptr<Point> pt2);
+            static std::shared_ptr<Segment> makeNewSegPtr(const std::shared_ptr<Point>& pt1, const std::shared_ptr<Point>& pt2);
              /**Maker function that calls the other constructor function and gets the segment on that pointer
              * @param pt1 a reference to a point 1 which will be used to create a segment
              * @param pt2 a reference to a point 2 which will be used to create a segment
              * @return the reference to a segment
              */
-			static Segment& makeNewSeg(std::shared_ptr<Point>  pt1, std::shared_ptr<Point>  pt2);
+			static Segment& makeNewSeg(const std::shared_ptr<Point>& pt1, const std::shared_ptr<Point>& pt2);
 
-            static Segment makeNewTempSeg(std::shared_ptr<Point>  pt1, std::shared_ptr<Point>  pt2);
+			/**	Same as makeNewSegPtr, from and to handles */
+			static SegmentId makeNewSegId(PointId pt1, PointId pt2);
 
-			static const std::vector<std::shared_ptr<Segment> >& getAllSegments(void){
-				return segVect_;
-			}
+            static Segment makeNewTempSeg(const std::shared_ptr<Point>& pt1, const std::shared_ptr<Point>& pt2);
 
-			static void clearAllSegments(void){
-				segSet_.clear();
-				count_ = 0;
-			}
+			/**	The segment a handle refers to */
+			static const Segment& getSegment(SegmentId id);
 
+			/**	The shared pointer to the segment a handle refers to, for the functions
+			 *	that still take one
+			 */
+			static const std::shared_ptr<Segment>& getSegmentPtr(SegmentId id);
+
+			static const std::vector<std::shared_ptr<Segment> >& getAllSegments(void);
+
+			/**	Removes all the segments of the default scene.
+			 *	@see Scene::clearAllSegments
+			 */
+			static void clearAllSegments(void);
+
+			static unsigned long long getVersion(void);
+
+			/**	@see Scene::setIncrementalIntersections */
+			static void setIncrementalIntersections(bool on);
+
+			static bool getIncrementalIntersections(void);
+
+			/**	@see Scene::getLiveIntersections */
+			static const std::vector<IntersectionRecord>& getLiveIntersections(void);
+
+			/**	@see Scene::setIndexCellSize */
+			static void setIndexCellSize(float size);
+
+#if GEOMETRY_RENDERING
 			static void renderCreated(const PointStruct& pt1, const PointStruct& pt2);
 			static void renderAllSegments(void);
+#endif
 	};
     /**Intersection function that finds all intersections between the segments using brute force
      * @param vect  reference to a vector of shared pointers to the segments whose intersections need to be found
      * @return a vector of unique pointers to type pointStruct that are intersection points
      */
     std::vector<std::unique_ptr<PointStruct> > findAllIntersectionsBruteForce(const std::vector<std::shared_ptr<Segment> >& vect);
+
+    /**Same as above, writing the intersections in a caller-provided buffer
+     * @param vect  reference to a vector of shared pointers to the segments whose intersections need to be found
+     * @param out  the buffer that receives the intersections
+     * @param reserveHint  expected number of intersections, to reserve room for in out (0 if unknown)
+     * @param append  if true, the intersections are added at the end of out, otherwise out is cleared first
+     */
+    void findAllIntersectionsBruteForce(const std::vector<std::shared_ptr<Segment> >& vect, std::vector<IntersectionRecord>& out,
+                                        size_t reserveHint = 0, bool append = false);
+
+    /**Multithreaded version of findAllIntersectionsBruteForce.  The (i, j>i) triangle of segment pairs
+     * is split into square tiles that the threads pick up one at a time, each thread collecting its
+     * intersections in its own buffer.  The buffers are merged at the end.
+     * @param vect  reference to a vector of shared pointers to the segments whose intersections need to be found
+     * @param numThreads  number of threads to use (0 means one per hardware thread)
+     * @param deterministic  if true, the intersections are returned in the same order as
+     *          findAllIntersectionsBruteForce; otherwise in whatever order the threads found them
+     * @return a vector of unique pointers to type pointStruct that are intersection points
+     */
+    std::vector<std::unique_ptr<PointStruct> > findAllIntersectionsBruteForceParallel(const std::vector<std::shared_ptr<Segment> >& vect,
+                                                                                      unsigned int numThreads = 0,
+                                                                                      bool deterministic = true);
+
+    /**Same as above, writing the intersections in a caller-provided buffer
+     * @see findAllIntersectionsBruteForce(const std::vector<std::shared_ptr<Segment> >&, std::vector<IntersectionRecord>&, size_t, bool)
+     */
+    void findAllIntersectionsBruteForceParallel(const std::vector<std::shared_ptr<Segment> >& vect, std::vector<IntersectionRecord>& out,
+                                                unsigned int numThreads = 0, bool deterministic = true,
+                                                size_t reserveHint = 0, bool append = false);
+
+    /**Intersection function that finds all intersections between the segments using a uniform grid:
+     * only the pairs of segments that cross a common grid cell are tested.  Each pair is tested once,
+     * and the intersections are returned in the same order as findAllIntersectionsBruteForce.
+     * This is much faster than brute force for scenes made of many short segments.
+     * @param vect  reference to a vector of shared pointers to the segments whose intersections need to be found
+     * @param cellSize  side of the grid's cells (0 means chosen from the distribution of segment lengths)
+     * @return a vector of unique pointers to type pointStruct that are intersection points
+     */
+    std::vector<std::unique_ptr<PointStruct> > findAllIntersectionsGrid(const std::vector<std::shared_ptr<Segment> >& vect,
+                                                                        float cellSize = 0.f);
+
+    /**Same as above, writing the intersections in a caller-provided buffer
+     * @see findAllIntersectionsBruteForce(const std::vector<std::shared_ptr<Segment> >&, std::vector<IntersectionRecord>&, size_t, bool)
+     */
+    void findAllIntersectionsGrid(const std::vector<std::shared_ptr<Segment> >& vect, std::vector<IntersectionRecord>& out,
+                                  float cellSize = 0.f, size_t reserveHint = 0, bool append = false);
+
+    /**Same as above, for the segments of a snapshot, which need not be segments of a scene
+     * (see SegmentSoA's constructor from coordinates).  segA and segB are the indices of the snapshot.
+     */
+    void findAllIntersectionsGrid(const SegmentSoA& coords, std::vector<IntersectionRecord>& out,
+                                  float cellSize = 0.f, size_t reserveHint = 0, bool append = false);
+
+    /**Same grid search, handing each intersection to a callback instead of storing it, for
+     * callers that write the intersections out as they are found
+     */
+    void forEachIntersectionGrid(const SegmentSoA& coords, const std::function<void(const IntersectionRecord&)>& found,
+                                 float cellSize = 0.f);
     
-    // Enum used to store all types of points in the queue
+    // Struct used to store all types of points in the queue
     struct InterQueueEvent{
         bool isIntersection;
+        //  For an endpoint event, true if this is the upper endpoint (the first one met by the sweep line)
+        bool isUpper;
         std::shared_ptr<Point> endpt;
         std::shared_ptr<PointStruct> interPt;
-        
+        //  For an endpoint event, the segment the point is an endpoint of.
+        //  For an intersection event, the two segments that intersect
+        std::shared_ptr<Segment> seg;
+        std::shared_ptr<Segment> otherSeg;
+        //  For an intersection event, true if the event was put back in the queue because the segments
+        //  had not crossed yet at the rounded intersection point (the intersection is already reported)
+        bool isDelayed = false;
 
+        inline float getX(void) const{
+            return isIntersection ? interPt->x : endpt->getX();
+        }
+        inline float getY(void) const{
+            return isIntersection ? interPt->y : endpt->getY();
+        }
     };
     /**
      *This function takes the points which lies on the segment and put them in the a vector
@@ -196,39 +365,89 @@ namespace geometry {
      */
     std::vector<std::shared_ptr<Point> > getAllEndPoints(const std::vector<std::shared_ptr<Segment> >& vect);
     
-    // Compare struct that helps to compare between InterQueueEvent points, to decide their position in the queue
+    /** Compare struct that helps to compare between InterQueueEvent points, to decide their position in the queue.
+     *  The sweep line moves from top to bottom, and from left to right along a horizontal line.
+     *  Events at the same location are ordered: lower endpoints first, then intersections, then upper endpoints,
+     *  and finally by segment index, so that distinct events never compare equal.
+     */
     struct compareEvent{
-      bool operator()(const std::shared_ptr<geometry::InterQueueEvent>  p1, const std::shared_ptr<geometry::InterQueueEvent> p2){
-          float x1;
-          float y1;
-          float x2;
-          float y2;
-          if((*p1).isIntersection){
-              x1 = ((*p1).interPt)->x;
-              y1 = ((*p1).interPt)->y;
-              x2 = ((*p2).interPt)->x;
-              y2 = ((*p2).interPt)->y;
-          }else{
-              x1 = ((*p1).endpt)->getX();
-              y1 = ((*p1).endpt)->getY();
-              x2 = ((*p2).endpt)->getX();
-              y2 = ((*p2).endpt)->getY();
-          }
+      bool operator()(const std::shared_ptr<geometry::InterQueueEvent>& p1, const std::shared_ptr<geometry::InterQueueEvent>& p2) const{
+          const float x1 = p1->getX();
+          const float y1 = p1->getY();
+          const float x2 = p2->getX();
+          const float y2 = p2->getY();
           
-          if(y1 == y2){
+          if(y1 != y2){
+              return y1 > y2;
+          }
+          if(x1 != x2){
               return x1 < x2;
-          }else{
-             return y1 > y2;
           }
+          const int rank1 = p1->isIntersection ? 1 : (p1->isUpper ? 2 : 0);
+          const int rank2 = p2->isIntersection ? 1 : (p2->isUpper ? 2 : 0);
+          if(rank1 != rank2){
+              return rank1 < rank2;
+          }
+          if(p1->seg->getIndex() != p2->seg->getIndex()){
+              return p1->seg->getIndex() < p2->seg->getIndex();
+          }
+          if(p1->isIntersection){
+              return p1->otherSeg->getIndex() < p2->otherSeg->getIndex();
+          }
+          return false;
       }
     };
-    // Compare struct that helps to compare between InterQueueEvent points, to decide their position in the queue
+
+    /** Current position of the sweep line: the location of the event being processed
+     */
+    struct SweepLine{
+        float x;
+        float y;
+    };
+
+    /** Compare struct that orders the segments crossed by the sweep line from left to right.
+     *  Segments are compared exactly by the x coordinate of their intersection with the sweep line,
+     *  so that the order is consistent whatever the roundoff.  Segments that meet the sweep line at
+     *  the same point are compared by their direction, i.e. by their order just below the sweep line,
+     *  and then by index.
+     */
     struct compareSegment{
-      bool operator()(const std::shared_ptr<geometry::Segment>  s1, const std::shared_ptr<geometry::Segment> s2){
+      const SweepLine* sweep = nullptr;
 
-          //return s2.p1_ is on left side of s1
-          return (*s1).isOnLeftSide((*s2).getP1());
-      }
+      /** Where a segment meets the sweep line: either at the float x (a horizontal segment, or a
+       *  segment that ends on the sweep line), or at the point of the line through its upper and lower points.
+       */
+      struct Position{
+        const Point* upper;
+        const Point* lower;
+        float x;
+        bool onLine;
+        bool horizontal;
+      };
+
+      bool operator()(const std::shared_ptr<geometry::Segment>& s1, const std::shared_ptr<geometry::Segment>& s2) const;
+
+      /** Computes where a segment meets the sweep line, exactly */
+      Position position(const Segment& seg) const;
+
+      /** Compares the directions of two segments going down, a horizontal segment being the
+       *  rightmost direction
+       *  @return -1 if the first segment is on the left of the second just below a point they share,
+       *          1 if it is on the right, 0 if they are parallel
+       */
+      static int compareDirection(const Position& pos1, const Position& pos2);
+
+      /** Computes where a segment meets the sweep line, approximately
+       *  @param seg - the segment to locate
+       *  @param x - the x coordinate of the intersection of the segment with the sweep line
+       *  @param slope - the change of x when we move down by one unit along the segment
+       */
+      void locate(const Segment& seg, double& x, double& slope) const;
+
+      /** Tells whether two locations along the sweep line coincide within the Geometry tolerances.
+       *  Only decides which segments around a new neighbor are checked for intersections, not the order.
+       */
+      static bool isSameX(double x1, double x2);
     };
     /**
      *This function creates a set of type InterQueueEvent, which is the event Queue
@@ -240,14 +459,39 @@ namespace geometry {
      *This function adds the intersection points in the eventQueue
      *@param eventQueue - a reference to the eventQueue set in which we will add the intersection point
      *@param currInterPt - the intersection point which has to be added in the eventQueue
+     *@param seg1 - one of the segments that intersect at currInterPt
+     *@param seg2 - the other segment that intersects at currInterPt
      */
-     void addEvent(std::set<std::shared_ptr<InterQueueEvent> , compareEvent>& eventQueue,std::shared_ptr<PointStruct> currInterPt);
+     void addEvent(std::set<std::shared_ptr<InterQueueEvent> , compareEvent>& eventQueue,std::shared_ptr<PointStruct> currInterPt,
+                   const std::shared_ptr<Segment>& seg1, const std::shared_ptr<Segment>& seg2);
     /**Intersection function that finds all intersections between the segments using smart way of computational geometry
+     * (Bentley-Ottmann plane sweep, in O((n+k) log n) for n segments and k intersections).
+     * It reports the same intersections as findAllIntersectionsBruteForce, in sweep order.
      * @param vect  reference to a vector of shared pointers to the segments whose intersections need to be found
      * @return a vector of unique pointers to type PointStruct that are intersection points
      */
     std::vector<std::unique_ptr<PointStruct> > findAllIntersectionsSmart(const std::vector<std::shared_ptr<Segment> >& vect);
-    void orderMap(std::map<int,unsigned int> prioritySegMap,const std::vector<std::shared_ptr<Segment> >& segVect, std::shared_ptr<InterQueueEvent> currPoint);
+
+    /**Same as above, writing the intersections in a caller-provided buffer
+     * @see findAllIntersectionsBruteForce(const std::vector<std::shared_ptr<Segment> >&, std::vector<IntersectionRecord>&, size_t, bool)
+     */
+    void findAllIntersectionsSmart(const std::vector<std::shared_ptr<Segment> >& vect, std::vector<IntersectionRecord>& out,
+                                   size_t reserveHint = 0, bool append = false);
+
+    /**Counts the intersections between the segments, without storing them.  Uses the same grid
+     * search as findAllIntersectionsGrid, so it returns the size of its result.
+     * @param vect  reference to a vector of shared pointers to the segments whose intersections need to be counted
+     * @return the number of pairs of segments that intersect
+     */
+    size_t countAllIntersections(const std::vector<std::shared_ptr<Segment> >& vect);
+
+    /**Tells whether any two segments intersect, e.g. to validate a network whose segments should only
+     * meet at their endpoints.  Runs the plane sweep of findAllIntersectionsSmart, but stops at the
+     * first intersection found (Shamos-Hoey), in O(n log n) when there is none.
+     * @param vect  reference to a vector of shared pointers to the segments to check
+     * @return true if at least two of the segments intersect
+     */
+    bool anyIntersection(const std::vector<std::shared_ptr<Segment> >& vect);
 
 }
 #endif /* Segment_hpp */
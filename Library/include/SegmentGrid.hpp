@@ -0,0 +1,212 @@
+//
+//  SegmentGrid.hpp
+//
+//	Uniform grids of segments, used as the broad phase of the intersection
+//	searches: two segments can only intersect if they are listed in a common cell.
+//	SegmentGrid is built at once over the bounding box of a list of segments,
+//	SegmentHashGrid grows one segment at a time.
+//
+
+#ifndef SegmentGrid_hpp
+#define SegmentGrid_hpp
+
+#include <memory>
+#include <vector>
+#include <span>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <climits>
+#include <unordered_map>
+#include "SegmentSoA.hpp"
+
+namespace geometry {
+
+	/**	Calls f(col, row) for each cell of a grid crossed by the segment (x1, y1)-(x2, y2)
+	 *	padded by pad, row by row.  For each row of cells, we compute the x extent of the
+	 *	part of the segment that lies in the row (also padded).  Cell (col, row) covers
+	 *	[x0 + col*cellSize, x0 + (col+1)*cellSize) x [y0 + row*cellSize, y0 + (row+1)*cellSize),
+	 *	and cell coordinates are clamped to [minCol, maxCol] x [minRow, maxRow].
+	 */
+	template <typename CellFunc>
+	void rasterizeSegment(float x1, float y1, float x2, float y2,
+						  double x0, double y0, double cellSize, double pad,
+						  int64_t minCol, int64_t maxCol, int64_t minRow, int64_t maxRow, CellFunc&& f){
+		auto cellOf = [cellSize](double v, int64_t minCell, int64_t maxCell){
+			double c = std::floor(v / cellSize);
+			return static_cast<int64_t>(std::clamp(c, static_cast<double>(minCell), static_cast<double>(maxCell)));
+		};
+		const double segYmin = std::min(y1, y2), segYmax = std::max(y1, y2);
+		const double dy = static_cast<double>(y2) - y1;
+		const double dxdy = dy != 0.0 ? (static_cast<double>(x2) - x1) / dy : 0.0;
+		const int64_t r0 = cellOf(segYmin - pad - y0, minRow, maxRow),
+					  r1 = cellOf(segYmax + pad - y0, minRow, maxRow);
+		for (int64_t r=r0; r<=r1; r++){
+			const double rowY = y0 + r*cellSize;
+			double ya = std::clamp(rowY - pad, segYmin, segYmax);
+			double yb = std::clamp(rowY + cellSize + pad, segYmin, segYmax);
+			double xa, xb;
+			if (dy != 0.0){
+				xa = x1 + (ya - y1) * dxdy;
+				xb = x1 + (yb - y1) * dxdy;
+			}else{
+				xa = x1;
+				xb = x2;
+			}
+			const int64_t c0 = cellOf(std::min(xa, xb) - pad - x0, minCol, maxCol);
+			const int64_t c1 = cellOf(std::max(xa, xb) + pad - x0, minCol, maxCol);
+			for (int64_t c=c0; c<=c1; c++){
+				f(c, r);
+			}
+		}
+	}
+
+	class SegmentGrid{
+
+		private:
+
+			float xmin_, ymin_;
+			float cellSize_;
+			/**	Padding applied around each segment when it is rasterized, so that
+			 *	two segments that the (float) orientation tests consider to be
+			 *	intersecting always share a cell.
+			 */
+			float pad_;
+			unsigned int numCols_, numRows_;
+			/**	Cell c lists the indices of the segments that cross it, in increasing
+			 *	order, in cellSegs_[cellStart_[c]] to cellSegs_[cellStart_[c+1]-1].
+			 */
+			std::vector<unsigned int> cellStart_;
+			std::vector<unsigned int> cellSegs_;
+
+		public:
+
+			/**	Builds the grid for a list of segments.
+			 *	@param soa	the segments to bucket.  Cells store indices in this snapshot.
+			 *	@param cellSize	side of the grid's cells.  If 0 or negative, the size
+			 *			is chosen by chooseCellSize.  It is increased if the grid would
+			 *			have too many cells for the number of segments.
+			 */
+			SegmentGrid(const SegmentSoA& soa, float cellSize = 0.f);
+
+			//	Disabled constructors and operators
+			SegmentGrid(void) = delete;
+			SegmentGrid(const SegmentGrid& ) = delete;
+			SegmentGrid& operator = (const SegmentGrid& ) = delete;
+
+			/**	Picks a cell size from the distribution of segment lengths: the median
+			 *	length, so that a typical segment crosses a handful of cells, but large
+			 *	enough that the grid doesn't have many more cells than segments.
+			 *	@param soa	the segments to bucket
+			 *	@param width	width of the bounding box of the segments
+			 *	@param height	height of the bounding box of the segments
+			 *	@return the side of the grid's cells
+			 */
+			static float chooseCellSize(const SegmentSoA& soa, float width, float height);
+
+			inline float getCellSize(void) const{
+				return cellSize_;
+			}
+			inline unsigned int getNumCols(void) const{
+				return numCols_;
+			}
+			inline unsigned int getNumRows(void) const{
+				return numRows_;
+			}
+			inline unsigned int getNumCells(void) const{
+				return numCols_ * numRows_;
+			}
+
+			/**	Number of pairs of segments that share a cell, counted once per shared cell.
+			 *	This is an upper bound on the number of pairs that a search over the
+			 *	grid has to test.
+			 */
+			double getNumCellPairs(void) const;
+
+			/**	The indices of the segments that cross a cell, in increasing order
+			 *	@param cell	index of the cell (row * getNumCols() + col)
+			 */
+			inline std::span<const unsigned int> getCell(unsigned int cell) const{
+				return std::span<const unsigned int>(cellSegs_.data() + cellStart_[cell],
+													 cellStart_[cell+1] - cellStart_[cell]);
+			}
+
+			/**	Calls f(cell) for each cell crossed by the (padded) segment (x1, y1)-(x2, y2)
+			 *	@see rasterizeSegment
+			 */
+			template <typename CellFunc>
+			void forEachCell(float x1, float y1, float x2, float y2, CellFunc&& f) const{
+				rasterizeSegment(x1, y1, x2, y2, xmin_, ymin_, cellSize_, pad_, 0, numCols_ - 1, 0, numRows_ - 1,
+								 [&](int64_t col, int64_t row){
+					f(static_cast<unsigned int>(row*numCols_ + col));
+				});
+			}
+	};
+
+	/**	Unbounded uniform grid, stored in a hash table, that segments can be added to
+	 *	one at a time.  Used to find quickly the segments that a new segment may intersect.
+	 */
+	class SegmentHashGrid{
+
+		private:
+
+			float cellSize_;
+			std::unordered_map<uint64_t, std::vector<unsigned int>, Key64Hash> cells_;
+
+			/**	Calls f(key) for the hash key of each cell crossed by the (padded) segment */
+			template <typename CellFunc>
+			void forEachCellKey_(float x1, float y1, float x2, float y2, CellFunc&& f) const{
+				//	same padding rule as SegmentGrid, but from the segment's own coordinates
+				const float pad = 1E-5f * std::max({std::fabs(x1), std::fabs(y1), std::fabs(x2), std::fabs(y2),
+												   std::fabs(x2 - x1), std::fabs(y2 - y1)});
+				rasterizeSegment(x1, y1, x2, y2, 0.0, 0.0, cellSize_, pad,
+								 INT32_MIN, INT32_MAX, INT32_MIN, INT32_MAX, [&](int64_t col, int64_t row){
+					f((static_cast<uint64_t>(static_cast<uint32_t>(col)) << 32) |
+					   static_cast<uint64_t>(static_cast<uint32_t>(row)));
+				});
+			}
+
+		public:
+
+			/**	@param cellSize	side of the grid's cells.  It should be about the length of a typical segment.
+			 */
+			SegmentHashGrid(float cellSize)
+				:	cellSize_(cellSize),
+					cells_()
+			{}
+
+			inline float getCellSize(void) const{
+				return cellSize_;
+			}
+
+			/**	Adds a segment to the grid
+			 *	@param id	the identifier reported by forEachCandidate for this segment
+			 */
+			void insert(unsigned int id, float x1, float y1, float x2, float y2){
+				forEachCellKey_(x1, y1, x2, y2, [&](uint64_t key){
+					cells_[key].push_back(id);
+				});
+			}
+
+			/**	Calls f(id) for each segment of the grid that shares a cell with the segment
+			 *	(x1, y1)-(x2, y2).  A segment that shares several cells is reported several times.
+			 */
+			template <typename IdFunc>
+			void forEachCandidate(float x1, float y1, float x2, float y2, IdFunc&& f) const{
+				forEachCellKey_(x1, y1, x2, y2, [&](uint64_t key){
+					auto iter = cells_.find(key);
+					if (iter != cells_.end()){
+						for (unsigned int id : iter->second){
+							f(id);
+						}
+					}
+				});
+			}
+
+			void clear(void){
+				cells_.clear();
+			}
+	};
+}
+
+#endif /* SegmentGrid_hpp */
@@ -0,0 +1,105 @@
+//
+//  SegmentSoA.hpp
+//
+//	Packed (structure of arrays) snapshot of the endpoint coordinates of a list
+//	of segments, for the kernels that sweep over all the segments.
+//
+
+#ifndef SegmentSoA_hpp
+#define SegmentSoA_hpp
+
+#include <memory>
+#include <vector>
+#include <span>
+#include <cstddef>
+#include "Segment.hpp"
+
+namespace geometry {
+
+	/**	A segment given by the coordinates of its endpoints, in the p1_/p2_ order
+	 *	of Segment (p1 is the lower endpoint), and an index of the caller's choice
+	 */
+	struct SegmentCoords{
+		float x1, y1, x2, y2;
+		unsigned int idx;
+	};
+
+	class SegmentSoA{
+
+		private:
+
+			/**	Alignment (in bytes) of the coordinate arrays */
+			static constexpr size_t ALIGNMENT = 64;
+
+			/**	Frees the block holding the coordinate arrays */
+			struct AlignedDelete_{
+				void operator()(float* block) const;
+			};
+
+			size_t size_;
+			/**	Length of each coordinate array, padding included */
+			size_t stride_;
+			std::unique_ptr<float[], AlignedDelete_> block_;
+			const float* x1_;
+			const float* y1_;
+			const float* x2_;
+			const float* y2_;
+			std::vector<unsigned int> index_;
+
+		public:
+
+			/**	Builds the snapshot of a list of segments, in O(n).  The arrays are
+			 *	64-byte aligned and padded with zero-length segments at the origin,
+			 *	so that a batch of ORIENTATION_BATCH_SIZE segments starting at any
+			 *	segment of the list can be read in full.
+			 *	@param vect	the segments, whose endpoints are stored in the p1_/p2_ order
+			 */
+			SegmentSoA(const std::vector<std::shared_ptr<Segment> >& vect);
+
+			/**	Builds the snapshot of segments that need not exist in any scene, e.g. a
+			 *	strip of a scene too large to load.  getIndex(k) is segs[k].idx.
+			 */
+			SegmentSoA(std::span<const SegmentCoords> segs);
+
+			//	Disabled constructors and operators.  A snapshot is immutable.
+			SegmentSoA(void) = delete;
+			SegmentSoA(const SegmentSoA& ) = delete;
+			SegmentSoA(SegmentSoA&& ) = delete;
+			SegmentSoA& operator = (const SegmentSoA& ) = delete;
+			SegmentSoA& operator = (SegmentSoA&& ) = delete;
+
+			~SegmentSoA(void) = default;
+
+			/**	Snapshot of all the segments of the default scene
+			 *	@see Scene::getSnapshot
+			 */
+			static std::shared_ptr<const SegmentSoA> getSnapshot(void);
+
+			/**	Snapshot of a list of segments: the cached one if the list is
+			 *	getAllSegments() of the scene of its segments, a new one otherwise.
+			 */
+			static std::shared_ptr<const SegmentSoA> getSnapshot(const std::vector<std::shared_ptr<Segment> >& vect);
+
+			inline size_t size(void) const{
+				return size_;
+			}
+			inline const float* x1(void) const{
+				return x1_;
+			}
+			inline const float* y1(void) const{
+				return y1_;
+			}
+			inline const float* x2(void) const{
+				return x2_;
+			}
+			inline const float* y2(void) const{
+				return y2_;
+			}
+			/**	Index (Segment::getIndex(), or SegmentCoords::idx) of the k-th segment of the snapshot */
+			inline unsigned int getIndex(size_t k) const{
+				return index_[k];
+			}
+	};
+}
+
+#endif /* SegmentSoA_hpp */
@@ -0,0 +1,171 @@
+//
+//  SmallVector.hpp
+//
+//	Vector of trivially copyable values that stores its first few elements
+//	inline, in the object itself, and only allocates memory when it grows
+//	beyond that.  Used for lists that are almost always short, like the
+//	segments incident to a point.
+//
+
+#ifndef SmallVector_hpp
+#define SmallVector_hpp
+
+#include <span>
+#include <algorithm>
+#include <type_traits>
+#include <cstddef>
+
+namespace geometry {
+
+	template <typename T, unsigned int N>
+	class SmallVector{
+
+		static_assert(std::is_trivially_copyable_v<T>, "SmallVector only stores trivially copyable values");
+		static_assert(N > 0, "SmallVector needs room for at least one element inline");
+
+		private:
+
+			unsigned int size_;
+			/**	N while the elements are stored inline */
+			unsigned int capacity_;
+			union{
+				T inline_[N];
+				T* heap_;
+			};
+
+			inline bool isInline_(void) const{
+				return capacity_ == N;
+			}
+
+			/**	Moves the elements to a heap block of at least the capacity requested */
+			void reserve_(unsigned int capacity){
+				T* block = new T[capacity];
+				std::copy(begin(), end(), block);
+				if (!isInline_()){
+					delete [] heap_;
+				}
+				heap_ = block;
+				capacity_ = capacity;
+			}
+
+		public:
+
+			SmallVector(void)
+				:	size_(0),
+					capacity_(N)
+			{}
+
+			SmallVector(const SmallVector& other)
+				:	size_(0),
+					capacity_(N)
+			{
+				*this = other;
+			}
+
+			SmallVector(SmallVector&& other)
+				:	size_(0),
+					capacity_(N)
+			{
+				*this = std::move(other);
+			}
+
+			~SmallVector(void){
+				if (!isInline_()){
+					delete [] heap_;
+				}
+			}
+
+			SmallVector& operator = (const SmallVector& other){
+				if (this != &other){
+					clear();
+					if (other.size_ > capacity_){
+						reserve_(other.size_);
+					}
+					std::copy(other.begin(), other.end(), data());
+					size_ = other.size_;
+				}
+				return *this;
+			}
+
+			SmallVector& operator = (SmallVector&& other){
+				if (this != &other){
+					if (other.isInline_()){
+						*this = static_cast<const SmallVector&>(other);
+					}else{
+						if (!isInline_()){
+							delete [] heap_;
+						}
+						heap_ = other.heap_;
+						capacity_ = other.capacity_;
+						size_ = other.size_;
+						other.capacity_ = N;
+					}
+					other.size_ = 0;
+				}
+				return *this;
+			}
+
+			inline unsigned int size(void) const{
+				return size_;
+			}
+			inline bool empty(void) const{
+				return size_ == 0;
+			}
+			inline T* data(void){
+				return isInline_() ? inline_ : heap_;
+			}
+			inline const T* data(void) const{
+				return isInline_() ? inline_ : heap_;
+			}
+			inline T* begin(void){
+				return data();
+			}
+			inline T* end(void){
+				return data() + size_;
+			}
+			inline const T* begin(void) const{
+				return data();
+			}
+			inline const T* end(void) const{
+				return data() + size_;
+			}
+			inline T& operator[](size_t k){
+				return data()[k];
+			}
+			inline const T& operator[](size_t k) const{
+				return data()[k];
+			}
+
+			/**	A view of the elements, valid until the vector is modified */
+			inline std::span<const T> view(void) const{
+				return std::span<const T>(data(), size_);
+			}
+
+			void push_back(const T& value){
+				if (size_ == capacity_){
+					reserve_(2*capacity_);
+				}
+				data()[size_++] = value;
+			}
+
+			/**	Removes the first element equal to value, if any, keeping the order of the others
+			 *	@return true if an element was removed
+			 */
+			bool erase(const T& value){
+				T* pos = std::find(begin(), end(), value);
+				if (pos == end()){
+					return false;
+				}
+				std::copy(pos + 1, end(), pos);
+				size_--;
+				return true;
+			}
+
+			/**	Removes all the elements.  Memory allocated on the heap, if any, is kept. */
+			inline void clear(void){
+				size_ = 0;
+			}
+	};
+}
+
+#endif /* SmallVector_hpp */
@@ -0,0 +1,41 @@
+//
+//  Arena.cpp
+//
+
+#include <algorithm>
+#include <new>
+
+#include "Arena.hpp"
+
+using namespace std;
+using namespace geometry;
+
+Arena::Arena(void)
+	:	chunks_(),
+		nextChunkSize_(FIRST_CHUNK_SIZE),
+		current_(nullptr),
+		available_(0),
+		bytesAllocated_(0)
+{
+}
+
+void Arena::newChunk_(size_t size){
+	const size_t chunkSize = std::max(nextChunkSize_, size);
+	//	new[] returns memory aligned for any standard type
+	chunks_.push_back(make_unique_for_overwrite<byte[]>(chunkSize));
+	current_ = chunks_.back().get();
+	available_ = chunkSize;
+	nextChunkSize_ = std::min(2*nextChunkSize_, MAX_CHUNK_SIZE);
+}
+
+void* Arena::allocate(size_t size, size_t alignment){
+	void* block = current_;
+	if (current_ == nullptr || std::align(alignment, size, block, available_) == nullptr){
+		newChunk_(size);
+		block = current_;
+	}
+	current_ = static_cast<byte*>(block) + size;
+	available_ -= size;
+	bytesAllocated_ += size;
+	return block;
+}
@@ -0,0 +1,66 @@
+//
+//  BufferedWriter.cpp
+//
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "BufferedWriter.hpp"
+
+using namespace std;
+using namespace geometry;
+
+BufferedWriter::BufferedWriter(const string& filePath, size_t bufferSize)
+	:	outFile_(filePath, ios::binary | ios::trunc),
+		buffer_(std::max(bufferSize, MAX_LINE_SIZE)),
+		size_(0)
+{}
+
+BufferedWriter::BufferedWriter(BufferedWriter&& other) noexcept
+	:	outFile_(std::move(other.outFile_)),
+		buffer_(std::move(other.buffer_)),
+		size_(std::exchange(other.size_, 0))
+{}
+
+BufferedWriter& BufferedWriter::operator = (BufferedWriter&& other){
+	if (this != &other){
+		if (outFile_.is_open()){
+			flush();
+		}
+		outFile_ = std::move(other.outFile_);
+		buffer_ = std::move(other.buffer_);
+		size_ = std::exchange(other.size_, 0);
+	}
+	return *this;
+}
+
+BufferedWriter::~BufferedWriter(void){
+	if (outFile_.is_open()){
+		flush();
+	}
+}
+
+void BufferedWriter::flush(void){
+	outFile_.write(buffer_.data(), static_cast<streamsize>(size_));
+	size_ = 0;
+}
+
+void BufferedWriter::write(const void* data, size_t size){
+	if (size_ + size > buffer_.size()){
+		flush();
+	}
+	//	large blocks skip the buffer
+	if (size >= buffer_.size()){
+		outFile_.write(static_cast<const char*>(data), static_cast<streamsize>(size));
+	}else{
+		memcpy(buffer_.data() + size_, data, size);
+		size_ += size;
+	}
+}
+
+bool BufferedWriter::close(void){
+	flush();
+	outFile_.close();
+	return !outFile_.fail();
+}
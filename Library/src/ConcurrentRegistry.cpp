@@ -0,0 +1,184 @@
+//
+//  ConcurrentRegistry.cpp
+//
+
+#include <algorithm>
+#include <climits>
+
+#include "ConcurrentRegistry.hpp"
+#include "Scene.hpp"
+#include "Counters.hpp"
+
+using namespace std;
+using namespace geometry;
+
+ConcurrentRegistry::ConcurrentRegistry(Scene& scene, unsigned int numShards)
+	:	scene_(scene),
+		numShards_(std::bit_ceil(std::max(numShards, 1U))),
+		pointShards_(make_unique<PointShard_[]>(numShards_)),
+		segShards_(make_unique<SegmentShard_[]>(numShards_)),
+		pointLocks_(),
+		pointBase_(0),
+		segBase_(0),
+		numPoints_(0),
+		numSegs_(0),
+		points_(),
+		segs_()
+{
+	reset_();
+}
+
+ConcurrentRegistry::~ConcurrentRegistry(void){
+	commit();
+}
+
+void ConcurrentRegistry::reset_(void){
+	for (unsigned int s=0; s<numShards_; s++){
+		pointShards_[s].arena = make_shared<Arena>();
+		pointShards_[s].grid.clear();
+		segShards_[s].arena = make_shared<Arena>();
+		segShards_[s].index.clear();
+	}
+	points_.clear();
+	segs_.clear();
+	pointBase_ = static_cast<unsigned int>(scene_.pointVect_.size());
+	segBase_ = static_cast<unsigned int>(scene_.segVect_.size());
+	numPoints_.store(0);
+	numSegs_.store(0);
+}
+
+const shared_ptr<Point>& ConcurrentRegistry::getPointPtr_(PointId id) const{
+	return id.idx < pointBase_ ? scene_.pointVect_[id.idx] : points_.at(id.idx - pointBase_);
+}
+
+PointStruct ConcurrentRegistry::getCoordinates(PointId id) const{
+	const Point& pt = *getPointPtr_(id);
+	return PointStruct(pt.getX(), pt.getY());
+}
+
+#if 0
+//-----------------------------------------------------------------
+#pragma mark -
+#pragma mark Points
+//-----------------------------------------------------------------
+#endif
+
+unsigned int ConcurrentRegistry::findNewPoint_(float xCoord, float yCoord, uint64_t key) const{
+	//	same search as Scene::findPoint_
+	unsigned int found = UINT_MAX;
+	auto cell = pointShards_[shardOf_(key)].grid.equal_range(key);
+	for (auto iter = cell.first; iter != cell.second; iter++){
+		GEOMETRY_COUNT(POINT_REGISTRY_PROBES);
+		const Point& pt = *points_.at(iter->second - pointBase_);
+		if (iter->second < found && pt.getX() == xCoord && pt.getY() == yCoord){
+			found = iter->second;
+		}
+	}
+	return found;
+}
+
+PointId ConcurrentRegistry::makeNewPointId(float xCoord, float yCoord){
+	/**	The points of the scene are not modified while the registry is in use,
+	 *	so they can be searched without a lock.
+	 */
+	const unsigned int idx = scene_.findPoint_(xCoord, yCoord);
+	if (idx != UINT_MAX){
+		return PointId{idx};
+	}
+
+	const uint64_t key = Scene::gridKey_(scene_.gridCell_(xCoord), scene_.gridCell_(yCoord));
+	PointShard_& shard = pointShards_[shardOf_(key)];
+	lock_guard<mutex> shardLock(shard.mutex);
+	unsigned int found = findNewPoint_(xCoord, yCoord, key);
+	if (found == UINT_MAX){
+		found = pointBase_ + numPoints_.fetch_add(1);
+		points_[found - pointBase_] = scene_.newPoint_(shard.arena, found, xCoord, yCoord);
+		shard.grid.emplace(key, found);
+	}
+	return PointId{found};
+}
+
+#if 0
+//-----------------------------------------------------------------
+#pragma mark -
+#pragma mark Segments
+//-----------------------------------------------------------------
+#endif
+
+SegmentId ConcurrentRegistry::makeNewSegId(PointId pt1, PointId pt2){
+	const uint64_t key = Scene::endpointKey_(pt1.idx, pt2.idx);
+	GEOMETRY_COUNT(SEGMENT_REGISTRY_PROBES);
+	auto iter = scene_.segIndex_.find(key);
+	if (iter != scene_.segIndex_.end()){
+		return SegmentId{iter->second};
+	}
+
+	SegmentShard_& shard = segShards_[shardOf_(key)];
+	lock_guard<mutex> shardLock(shard.mutex);
+	GEOMETRY_COUNT(SEGMENT_REGISTRY_PROBES);
+	auto newIter = shard.index.find(key);
+	if (newIter != shard.index.end()){
+		return SegmentId{newIter->second};
+	}
+	unsigned int idx;
+	{
+		/**	The segment adds itself to the lists of segments of its endpoints, which
+		 *	other threads may be adding to as well.  These locks are only taken last,
+		 *	in increasing order, so they can't deadlock.  The index is taken under
+		 *	them: two segments that share an endpoint then get their indices in the
+		 *	order they are added to its list, which stays sorted.
+		 */
+		const unsigned int lock1 = std::min(pt1.idx % NUM_POINT_LOCKS, pt2.idx % NUM_POINT_LOCKS);
+		const unsigned int lock2 = std::max(pt1.idx % NUM_POINT_LOCKS, pt2.idx % NUM_POINT_LOCKS);
+		lock_guard<mutex> pointLock1(pointLocks_[lock1]);
+		unique_lock<mutex> pointLock2(pointLocks_[lock2], defer_lock);
+		if (lock2 != lock1){
+			pointLock2.lock();
+		}
+		idx = segBase_ + numSegs_.fetch_add(1);
+		segs_[idx - segBase_] = Scene::newSegment_(shard.arena, idx, getPointPtr_(pt1), getPointPtr_(pt2));
+	}
+	shard.index.emplace(key, idx);
+	return SegmentId{idx};
+}
+
+#if 0
+//-----------------------------------------------------------------
+#pragma mark -
+#pragma mark Commit
+//-----------------------------------------------------------------
+#endif
+
+void ConcurrentRegistry::commit(void){
+	const unsigned int numPoints = numPoints_.load();
+	const unsigned int numSegs = numSegs_.load();
+	if (numPoints == 0 && numSegs == 0){
+		return;
+	}
+
+	scene_.pointVect_.reserve(scene_.pointVect_.size() + numPoints);
+	scene_.pointGrid_.reserve(scene_.pointGrid_.size() + numPoints);
+	for (unsigned int k=0; k<numPoints; k++){
+		scene_.pointVect_.push_back(std::move(points_[k]));
+		scene_.addToGrid_(*scene_.pointVect_.back());
+	}
+
+	scene_.segVect_.reserve(scene_.segVect_.size() + numSegs);
+	for (unsigned int k=0; k<numSegs; k++){
+		scene_.segVect_.push_back(std::move(segs_[k]));
+	}
+	scene_.segIndex_.reserve(scene_.segIndex_.size() + numSegs);
+	for (unsigned int s=0; s<numShards_; s++){
+		for (const auto& entry : segShards_[s].index){
+			scene_.segIndex_.emplace(entry.first, entry.second);
+		}
+	}
+	if (numSegs > 0){
+		scene_.segVersion_++;
+		if (scene_.incremental_){
+			scene_.rebuildLiveIntersections_();
+		}
+	}
+
+	reset_();
+}
@@ -0,0 +1,108 @@
+//
+//  Counters.cpp
+//
+
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+#include "Counters.hpp"
+
+using namespace std;
+using namespace geometry;
+
+static const char* const COUNTER_NAMES[NUM_COUNTERS] = {
+	"orientation_tests",
+	"exact_orientation_tests",
+	"segment_pair_tests",
+	"intersection_points",
+	"sweep_queue_inserts",
+	"sweep_queue_pops",
+	"sweep_status_comparisons",
+	"point_registry_probes",
+	"segment_registry_probes"
+};
+
+#if GEOMETRY_COUNTERS
+
+/**	The counters of the running threads, the counts of the threads that ended, and the
+ *	counts at the last reset
+ */
+struct CounterRegistry_{
+	mutex lock;
+	vector<ThreadCounters_*> threads;
+	CounterValues ended;
+	CounterValues reset;
+};
+
+/**	Created on first use, which is the construction of the first thread's counters, so
+ *	that it outlives them
+ */
+static CounterRegistry_& registry_(void){
+	static CounterRegistry_ registry;
+	return registry;
+}
+
+ThreadCounters_::ThreadCounters_(void){
+	for (atomic<uint64_t>& value : values){
+		value.store(0, memory_order_relaxed);
+	}
+	CounterRegistry_& registry = registry_();
+	lock_guard<mutex> guard(registry.lock);
+	registry.threads.push_back(this);
+}
+
+ThreadCounters_::~ThreadCounters_(void){
+	CounterRegistry_& registry = registry_();
+	lock_guard<mutex> guard(registry.lock);
+	for (size_t k=0; k<NUM_COUNTERS; k++){
+		registry.ended.values[k] += values[k].load(memory_order_relaxed);
+	}
+	registry.threads.erase(find(registry.threads.begin(), registry.threads.end(), this));
+}
+
+/**	Sums of the counts of all the threads since they started.  The registry must be locked.
+ */
+static CounterValues totals_(const CounterRegistry_& registry){
+	CounterValues totals = registry.ended;
+	for (const ThreadCounters_* counters : registry.threads){
+		for (size_t k=0; k<NUM_COUNTERS; k++){
+			totals.values[k] += counters->values[k].load(memory_order_relaxed);
+		}
+	}
+	return totals;
+}
+
+CounterValues geometry::getCounters(void){
+	CounterRegistry_& registry = registry_();
+	lock_guard<mutex> guard(registry.lock);
+	CounterValues counts = totals_(registry);
+	for (size_t k=0; k<NUM_COUNTERS; k++){
+		counts.values[k] -= registry.reset.values[k];
+	}
+	return counts;
+}
+
+/**	The counts are not cleared, as their threads could be adding to them: the totals at the
+ *	reset are subtracted from later totals instead
+ */
+void geometry::resetCounters(void){
+	CounterRegistry_& registry = registry_();
+	lock_guard<mutex> guard(registry.lock);
+	registry.reset = totals_(registry);
+}
+
+#else
+
+CounterValues geometry::getCounters(void){
+	return CounterValues();
+}
+
+void geometry::resetCounters(void){
+}
+
+#endif
+
+const char* geometry::getCounterName(Counter counter){
+	return COUNTER_NAMES[static_cast<size_t>(counter)];
+}
@@ -0,0 +1,57 @@
+//
+//  MappedFile.cpp
+//
+
+#include <fstream>
+#include <iterator>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "MappedFile.hpp"
+
+using namespace std;
+using namespace geometry;
+
+MappedFile::MappedFile(const string& filePath)
+	:	map_(MAP_FAILED),
+		size_(0),
+		contents_(),
+		isOpen_(false)
+{
+	const int fd = open(filePath.c_str(), O_RDONLY);
+	if (fd < 0){
+		return;
+	}
+	struct stat info;
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0){
+		size_ = static_cast<size_t>(info.st_size);
+		map_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd);
+	if (map_ == MAP_FAILED){
+		ifstream inFile(filePath, ios::binary);
+		if (!inFile.is_open()){
+			return;
+		}
+		contents_.assign(istreambuf_iterator<char>(inFile), istreambuf_iterator<char>());
+	}
+	isOpen_ = true;
+}
+
+MappedFile::~MappedFile(void){
+	if (map_ != MAP_FAILED){
+		munmap(map_, size_);
+	}
+}
+
+string_view MappedFile::getText(void) const{
+	return map_ != MAP_FAILED ? string_view(static_cast<const char*>(map_), size_) : string_view(contents_);
+}
+
+void MappedFile::adviseSequential(void) const{
+	if (map_ != MAP_FAILED){
+		madvise(map_, size_, MADV_SEQUENTIAL);
+	}
+}
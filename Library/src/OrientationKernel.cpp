@@ -0,0 +1,209 @@
+//
+//  OrientationKernel.cpp
+//
+//	The orientation tests are evaluated in float with a static error bound (see
+//	Predicates.hpp).  Lanes whose sign is certain get their answer right away; for the
+//	(rare) lanes where one of the four determinants is too close to 0, the pair is
+//	tested again with the exact scalar predicate.  Either way the answer is the exact
+//	one, hence the same as Segment::intersects.
+//
+
+#include <cfloat>
+#include <bit>
+
+#if defined(__AVX512F__) || defined(__AVX__) || defined(__SSE2__)
+	#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	#include <arm_neon.h>
+#endif
+
+#include "OrientationKernel.hpp"
+#include "Predicates.hpp"
+
+using namespace geometry;
+
+#if 0
+//-------------------------------
+#pragma mark -
+#pragma mark Instruction set specific operations
+//-------------------------------
+#endif
+
+//	For each instruction set, a vector type and the handful of operations the kernel needs.
+//	gtMask_(a, b) returns the bitmask of the lanes where a > b (false for NaN).
+#if defined(__AVX512F__)
+
+	#define ORIENTATION_KERNEL_NAME	"AVX-512"
+	using Vec_ = __m512;
+	constexpr unsigned int LANES_ = 16;
+	static inline Vec_ set1_(float v){ return _mm512_set1_ps(v); }
+	static inline Vec_ load_(const float* p){ return _mm512_loadu_ps(p); }
+	static inline Vec_ add_(Vec_ a, Vec_ b){ return _mm512_add_ps(a, b); }
+	static inline Vec_ sub_(Vec_ a, Vec_ b){ return _mm512_sub_ps(a, b); }
+	static inline Vec_ mul_(Vec_ a, Vec_ b){ return _mm512_mul_ps(a, b); }
+	static inline Vec_ abs_(Vec_ a){ return _mm512_abs_ps(a); }
+	static inline uint32_t gtMask_(Vec_ a, Vec_ b){ return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+
+#elif defined(__AVX__)
+
+	#define ORIENTATION_KERNEL_NAME	"AVX"
+	using Vec_ = __m256;
+	constexpr unsigned int LANES_ = 8;
+	static inline Vec_ set1_(float v){ return _mm256_set1_ps(v); }
+	static inline Vec_ load_(const float* p){ return _mm256_loadu_ps(p); }
+	static inline Vec_ add_(Vec_ a, Vec_ b){ return _mm256_add_ps(a, b); }
+	static inline Vec_ sub_(Vec_ a, Vec_ b){ return _mm256_sub_ps(a, b); }
+	static inline Vec_ mul_(Vec_ a, Vec_ b){ return _mm256_mul_ps(a, b); }
+	static inline Vec_ abs_(Vec_ a){ return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+	static inline uint32_t gtMask_(Vec_ a, Vec_ b){
+		return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ)));
+	}
+
+#elif defined(__SSE2__)
+
+	#define ORIENTATION_KERNEL_NAME	"SSE"
+	using Vec_ = __m128;
+	constexpr unsigned int LANES_ = 4;
+	static inline Vec_ set1_(float v){ return _mm_set1_ps(v); }
+	static inline Vec_ load_(const float* p){ return _mm_loadu_ps(p); }
+	static inline Vec_ add_(Vec_ a, Vec_ b){ return _mm_add_ps(a, b); }
+	static inline Vec_ sub_(Vec_ a, Vec_ b){ return _mm_sub_ps(a, b); }
+	static inline Vec_ mul_(Vec_ a, Vec_ b){ return _mm_mul_ps(a, b); }
+	static inline Vec_ abs_(Vec_ a){ return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+	static inline uint32_t gtMask_(Vec_ a, Vec_ b){
+		return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpgt_ps(a, b)));
+	}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+	#define ORIENTATION_KERNEL_NAME	"NEON"
+	using Vec_ = float32x4_t;
+	constexpr unsigned int LANES_ = 4;
+	static inline Vec_ set1_(float v){ return vdupq_n_f32(v); }
+	static inline Vec_ load_(const float* p){ return vld1q_f32(p); }
+	static inline Vec_ add_(Vec_ a, Vec_ b){ return vaddq_f32(a, b); }
+	static inline Vec_ sub_(Vec_ a, Vec_ b){ return vsubq_f32(a, b); }
+	//	vmulq rather than vmlaq/vmlsq, which may be fused
+	static inline Vec_ mul_(Vec_ a, Vec_ b){ return vmulq_f32(a, b); }
+	static inline Vec_ abs_(Vec_ a){ return vabsq_f32(a); }
+	static inline uint32_t gtMask_(Vec_ a, Vec_ b){
+		const uint32_t laneBits[4] = {1, 2, 4, 8};
+		return vaddvq_u32(vandq_u32(vcgtq_f32(a, b), vld1q_u32(laneBits)));
+	}
+
+#else
+
+	#define ORIENTATION_KERNEL_NAME	"scalar"
+	using Vec_ = float;
+	constexpr unsigned int LANES_ = 1;
+	static inline Vec_ set1_(float v){ return v; }
+	static inline Vec_ load_(const float* p){ return *p; }
+	static inline Vec_ add_(Vec_ a, Vec_ b){ return a + b; }
+	static inline Vec_ sub_(Vec_ a, Vec_ b){ return a - b; }
+	static inline Vec_ mul_(Vec_ a, Vec_ b){ return a * b; }
+	static inline Vec_ abs_(Vec_ a){ return a < 0.f ? -a : a; }
+	static inline uint32_t gtMask_(Vec_ a, Vec_ b){ return a > b ? 1U : 0U; }
+
+#endif
+
+#if 0
+//-------------------------------
+#pragma mark -
+#pragma mark Kernel
+//-------------------------------
+#endif
+
+/**	Filtered sign of the determinant left - right: positive and negative get the lanes where it
+ *	is certainly positive or negative.  In the other lanes its sign is not certain.  The FLT_MIN
+ *	term covers underflow in the products.
+ */
+static inline void filteredSign_(Vec_ left, Vec_ right, uint32_t& positive, uint32_t& negative){
+	const Vec_ det = sub_(left, right);
+	const Vec_ bound = add_(mul_(set1_(ORIENTATION_ERR_BOUND_FLOAT), add_(abs_(left), abs_(right))), set1_(FLT_MIN));
+	positive = gtMask_(det, bound);
+	negative = gtMask_(sub_(set1_(0.f), det), bound);
+}
+
+/**	Orientation tests of segA against the LANES_ segments starting at x1, y1, x2, y2
+ *	@param ambiguous	set to the lanes that need to be tested again with the exact predicate
+ *	@return the lanes whose segment certainly crosses segA
+ */
+static inline uint32_t intersectsLanes_(float ax1, float ay1, float ax2, float ay2,
+										const float* x1, const float* y1, const float* x2, const float* y2,
+										uint32_t& ambiguous){
+	const Vec_ vax1 = set1_(ax1), vay1 = set1_(ay1);
+	const Vec_ vax2 = set1_(ax2), vay2 = set1_(ay2);
+	const Vec_ adx = set1_(ax2 - ax1), ady = set1_(ay2 - ay1);
+	const Vec_ bx1 = load_(x1), by1 = load_(y1);
+	const Vec_ bx2 = load_(x2), by2 = load_(y2);
+	const Vec_ bdx = sub_(bx2, bx1), bdy = sub_(by2, by1);
+	
+	uint32_t pos1, pos2, pos3, pos4, neg1, neg2, neg3, neg4;
+	//	endpoints of the batch segments relative to segA
+	filteredSign_(mul_(sub_(bx1, vax1), ady), mul_(adx, sub_(by1, vay1)), pos1, neg1);
+	filteredSign_(mul_(sub_(bx2, vax1), ady), mul_(adx, sub_(by2, vay1)), pos2, neg2);
+	//	endpoints of segA relative to the batch segments
+	filteredSign_(mul_(sub_(vax1, bx1), bdy), mul_(bdx, sub_(vay1, by1)), pos3, neg3);
+	filteredSign_(mul_(sub_(vax2, bx1), bdy), mul_(bdx, sub_(vay2, by1)), pos4, neg4);
+	
+	//	A pair of endpoints is certainly on opposite sides, or certainly not: both signs are
+	//	known and they are equal.  Either of the latter is enough to rule the lane out.
+	const uint32_t opposite12 = (pos1 & neg2) | (neg1 & pos2);
+	const uint32_t opposite34 = (pos3 & neg4) | (neg3 & pos4);
+	const uint32_t sameSide12 = (pos1 & pos2) | (neg1 & neg2);
+	const uint32_t sameSide34 = (pos3 & pos4) | (neg3 & neg4);
+	const uint32_t laneMask = (1U << LANES_) - 1U;
+	const uint32_t crossing = opposite12 & opposite34 & laneMask;
+	ambiguous = ~(crossing | sameSide12 | sameSide34) & laneMask;
+	return crossing;
+}
+
+/**	The exact test of Segment::intersects, for the lanes the filter couldn't decide */
+static inline bool intersectsExact_(float ax1, float ay1, float ax2, float ay2,
+									float bx1, float by1, float bx2, float by2){
+	const int o1 = orientation(ax1, ay1, ax2, ay2, bx1, by1);
+	const int o2 = orientation(ax1, ay1, ax2, ay2, bx2, by2);
+	if (o1 * o2 >= 0){
+		return false;
+	}
+	const int o3 = orientation(bx1, by1, bx2, by2, ax1, ay1);
+	const int o4 = orientation(bx1, by1, bx2, by2, ax2, ay2);
+	return o3 * o4 < 0;
+}
+
+#if 0
+//-------------------------------
+#pragma mark -
+#pragma mark Public interface
+//-------------------------------
+#endif
+
+uint32_t geometry::intersectsBatch(float ax1, float ay1, float ax2, float ay2,
+								   const float* x1, const float* y1, const float* x2, const float* y2,
+								   size_t count){
+	GEOMETRY_COUNT_N(SEGMENT_PAIR_TESTS, count);
+	GEOMETRY_COUNT_N(ORIENTATION_TESTS, 4*count);
+	uint32_t mask = 0, ambiguous = 0;
+	for (unsigned int k=0; k<ORIENTATION_BATCH_SIZE; k+=LANES_){
+		uint32_t laneAmbiguous;
+		mask |= intersectsLanes_(ax1, ay1, ax2, ay2, x1+k, y1+k, x2+k, y2+k, laneAmbiguous) << k;
+		ambiguous |= laneAmbiguous << k;
+	}
+	if (count < ORIENTATION_BATCH_SIZE){
+		const uint32_t countMask = (1U << count) - 1U;
+		mask &= countMask;
+		ambiguous &= countMask;
+	}
+	while (ambiguous != 0){
+		const unsigned int k = static_cast<unsigned int>(std::countr_zero(ambiguous));
+		if (intersectsExact_(ax1, ay1, ax2, ay2, x1[k], y1[k], x2[k], y2[k])){
+			mask |= 1U << k;
+		}
+		ambiguous &= ambiguous - 1;
+	}
+	return mask;
+}
+
+const char* geometry::orientationKernelName(void){
+	return ORIENTATION_KERNEL_NAME;
+}
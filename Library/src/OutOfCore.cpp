@@ -0,0 +1,555 @@
+//
+//  OutOfCore.cpp
+//
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <limits>
+#include <atomic>
+#include <type_traits>
+#include <tuple>
+#include <unistd.h>
+
+#include "OutOfCore.hpp"
+#include "BufferedWriter.hpp"
+#include "MappedFile.hpp"
+#include "SegmentSoA.hpp"
+
+using namespace std;
+using namespace geometry;
+
+/**	Memory used by a segment of the strip being searched: its record, its coordinates in
+ *	the snapshot, and its entries in the cells of the grid
+ */
+#define BYTES_PER_STRIP_SEGMENT	128
+
+/**	Maximum number of strips a partition writes at once */
+#define MAX_STRIPS	256
+
+/**	Fraction (as a divisor) of the budget used by the buffers of the strip files */
+#define WRITE_BUFFER_DIVISOR	4
+
+static_assert(is_trivially_copyable_v<SegmentCoords>, "The segments are written to the strip files as they are");
+
+static SceneFileStatus setError_(SceneFileError& error, SceneFileStatus status, string message){
+	error.status = status;
+	error.lineNumber = 0;
+	error.message = std::move(message);
+	return status;
+}
+
+/**	The segment between two points, with its endpoints in the order of Segment's constructor
+ */
+static inline SegmentCoords makeCoords_(const PointStruct& pt1, const PointStruct& pt2, unsigned int idx){
+	const bool firstIsLower = pt1.y < pt2.y;
+	const PointStruct& p1 = firstIsLower ? pt1 : pt2;
+	const PointStruct& p2 = firstIsLower ? pt2 : pt1;
+	return SegmentCoords{p1.x, p1.y, p2.x, p2.y, idx};
+}
+
+/**	Removes the segments that join the same two points as a segment of lower index, which a
+ *	scene merges with it (see Scene::makeNewSegPtr).  All the copies of a segment are in the
+ *	same strips, so every strip keeps the same one.
+ *	@param segs	segments in increasing order of index, which they stay in
+ */
+static void removeDuplicates_(vector<SegmentCoords>& segs){
+	//	the endpoints in the order of makeCoords_, except that of a horizontal segment, which depends on the file
+	const auto key = [&segs](unsigned int k){
+		const SegmentCoords& seg = segs[k];
+		return (seg.y1 != seg.y2 || seg.x1 <= seg.x2) ? make_tuple(seg.y1, seg.x1, seg.y2, seg.x2)
+													  : make_tuple(seg.y2, seg.x2, seg.y1, seg.x1);
+	};
+	vector<unsigned int> order(segs.size());
+	for (unsigned int k=0; k<order.size(); k++){
+		order[k] = k;
+	}
+	std::stable_sort(order.begin(), order.end(), [&key](unsigned int a, unsigned int b){
+		return key(a) < key(b);
+	});
+	vector<bool> isDuplicate(segs.size(), false);
+	bool hasDuplicates = false;
+	for (size_t k=1; k<order.size(); k++){
+		if (key(order[k]) == key(order[k-1])){
+			isDuplicate[order[k]] = true;
+			hasDuplicates = true;
+		}
+	}
+	if (hasDuplicates){
+		size_t numKept = 0;
+		for (size_t k=0; k<segs.size(); k++){
+			if (!isDuplicate[k]){
+				segs[numKept++] = segs[k];
+			}
+		}
+		segs.resize(numKept);
+	}
+}
+
+#if 0
+//-----------------------------------------------------------------
+#pragma mark -
+#pragma mark Strip files
+//-----------------------------------------------------------------
+#endif
+
+/**	Directory of the temporary files, deleted with its contents
+ */
+class TempDirectory_{
+
+	private:
+
+		filesystem::path path_;
+		bool isCreated_;
+		unsigned int numFiles_;
+
+	public:
+
+		explicit TempDirectory_(const string& parentPath)
+			:	path_(),
+				isCreated_(false),
+				numFiles_(0)
+		{
+			static atomic<unsigned int> numDirectories(0);
+			error_code ec;
+			const filesystem::path parent = parentPath.empty() ? filesystem::temp_directory_path(ec)
+															   : filesystem::path(parentPath);
+			if (!ec){
+				path_ = parent / ("segstrips-" + to_string(getpid()) + "-" + to_string(numDirectories++));
+				isCreated_ = filesystem::create_directories(path_, ec);
+			}
+		}
+
+		TempDirectory_(const TempDirectory_& ) = delete;
+		TempDirectory_& operator = (const TempDirectory_& ) = delete;
+
+		~TempDirectory_(void){
+			if (isCreated_){
+				error_code ec;
+				filesystem::remove_all(path_, ec);
+			}
+		}
+
+		inline bool isCreated(void) const{
+			return isCreated_;
+		}
+
+		inline string getPath(void) const{
+			return path_.string();
+		}
+
+		/**	Path of a new file of the directory */
+		string makeFilePath(void){
+			return (path_ / ("strip-" + to_string(numFiles_++) + ".bin")).string();
+		}
+};
+
+/**	Segments whose y range meets [lo, hi), stored in a file in increasing order of index
+ */
+struct Strip_{
+	string filePath;
+	float lo;
+	float hi;
+	size_t numSegments;
+	/**	Number of segments whose y range contains [lo, hi], which are in all the strips it is split into */
+	size_t numSpanning;
+	/**	Extent of the y ranges of the segments */
+	float minY;
+	float maxY;
+};
+
+/**	Writes a stream of segments to the strip files of a partition of [lo, hi).  The
+ *	boundaries between the strips are evenly spaced in [splitLo, splitHi], and the first
+ *	and last strips extend to lo and hi.  A segment is written to every strip its y range
+ *	meets, in the order the segments are added.
+ */
+class Partition_{
+
+	private:
+
+		vector<float> inner_;
+		vector<Strip_> strips_;
+		vector<BufferedWriter> writers_;
+
+	public:
+
+		Partition_(TempDirectory_& dir, float lo, float hi, float splitLo, float splitHi, unsigned int numStrips,
+				   size_t bufferSize)
+			:	inner_(),
+				strips_(),
+				writers_()
+		{
+			for (unsigned int k=1; k<numStrips; k++){
+				inner_.push_back(static_cast<float>(splitLo + (static_cast<double>(splitHi) - splitLo) * k / numStrips));
+			}
+			strips_.reserve(numStrips);
+			writers_.reserve(numStrips);
+			for (unsigned int k=0; k<numStrips; k++){
+				strips_.push_back(Strip_{dir.makeFilePath(), (k == 0) ? lo : inner_[k-1],
+										 (k+1 == numStrips) ? hi : inner_[k], 0, 0,
+										 numeric_limits<float>::infinity(), -numeric_limits<float>::infinity()});
+				writers_.emplace_back(strips_.back().filePath, bufferSize);
+			}
+		}
+
+		bool isOpen(void) const{
+			return std::all_of(writers_.begin(), writers_.end(), [](const BufferedWriter& writer){
+				return writer.isOpen();
+			});
+		}
+
+		void add(const SegmentCoords& seg){
+			//	strips [first, last] are those that contain y1 and y2, and all those in between
+			const size_t first = static_cast<size_t>(std::upper_bound(inner_.begin(), inner_.end(), seg.y1) - inner_.begin());
+			const size_t last = static_cast<size_t>(std::upper_bound(inner_.begin(), inner_.end(), seg.y2) - inner_.begin());
+			for (size_t k=first; k<=last; k++){
+				writers_[k].write(&seg, sizeof(SegmentCoords));
+				Strip_& strip = strips_[k];
+				strip.numSegments++;
+				if (seg.y1 <= strip.lo && strip.hi <= seg.y2){
+					strip.numSpanning++;
+				}
+				strip.minY = std::min(strip.minY, seg.y1);
+				strip.maxY = std::max(strip.maxY, seg.y2);
+			}
+		}
+
+		/**	Closes the strip files
+		 *	@param strips	receives the strips
+		 *	@return false if a write failed
+		 */
+		bool close(vector<Strip_>& strips){
+			bool ok = true;
+			for (BufferedWriter& writer : writers_){
+				ok = writer.close() && ok;
+			}
+			strips = std::move(strips_);
+			return ok;
+		}
+};
+
+#if 0
+//-----------------------------------------------------------------
+#pragma mark -
+#pragma mark Search
+//-----------------------------------------------------------------
+#endif
+
+/**	State of a search: the segments of the scene are added to the first partition
+ *	(begin, add), then the strips are searched (finish).
+ */
+class OutOfCoreSearch_{
+
+	private:
+
+		const OutOfCoreSettings& settings_;
+		TempDirectory_ tempDir_;
+		BufferedWriter out_;
+		OutOfCoreStats stats_;
+		/**	Number of segments a strip can have to be searched within the budget */
+		size_t capacity_;
+		unique_ptr<Partition_> partition_;
+		bool writeFailed_;
+
+		inline size_t getBufferSize_(unsigned int numStrips) const{
+			return std::clamp(settings_.memoryBudget / (WRITE_BUFFER_DIVISOR * size_t(numStrips)),
+							  BufferedWriter::MAX_LINE_SIZE, BufferedWriter::DEFAULT_BUFFER_SIZE);
+		}
+
+		/**	Number of strips to split numSegments segments into, so that each fits in the budget
+		 *	(with room for the segments that several strips share)
+		 */
+		inline unsigned int getNumStrips_(size_t numSegments) const{
+			return static_cast<unsigned int>(std::clamp<size_t>((2 * numSegments + capacity_ - 1) / capacity_,
+																1, MAX_STRIPS));
+		}
+
+		/**	Searches a strip in memory, and writes out the intersections it owns: those whose
+		 *	common y range of the two segments starts in [lo, hi).  Every strip that has both
+		 *	segments finds the intersection, but only one strip owns it.
+		 */
+		void search_(const Strip_& strip){
+			vector<SegmentCoords> segs(strip.numSegments);
+			{
+				ifstream inFile(strip.filePath, ios::binary);
+				inFile.read(reinterpret_cast<char*>(segs.data()), static_cast<streamsize>(segs.size() * sizeof(SegmentCoords)));
+				if (static_cast<size_t>(inFile.gcount()) != segs.size() * sizeof(SegmentCoords)){
+					writeFailed_ = true;
+					return;
+				}
+			}
+			error_code ec;
+			filesystem::remove(strip.filePath, ec);
+			stats_.numStrips++;
+			stats_.maxStripSegments = std::max(stats_.maxStripSegments, segs.size());
+			removeDuplicates_(segs);
+
+			const SegmentSoA coords(segs);
+			const auto find = [&segs](unsigned int idx) -> const SegmentCoords&{
+				return *std::lower_bound(segs.begin(), segs.end(), idx, [](const SegmentCoords& seg, unsigned int idx){
+					return seg.idx < idx;
+				});
+			};
+			forEachIntersectionGrid(coords, [&](const IntersectionRecord& inter){
+				const float y = std::max(find(inter.segA).y1, find(inter.segB).y1);
+				if (strip.lo <= y && y < strip.hi){
+					writeIntersectionLine(out_, inter);
+					stats_.numIntersections++;
+				}
+			}, settings_.cellSize);
+		}
+
+		/**	Searches a strip, splitting it first if it is too large for the budget, unless the
+		 *	segments that span it take half of the budget: they would fill all the smaller strips.
+		 *	@param canSplit	false if splitting the strip's parent didn't make it smaller
+		 */
+		void process_(const Strip_& strip, bool canSplit){
+			if (strip.numSegments == 0){
+				error_code ec;
+				filesystem::remove(strip.filePath, ec);
+				return;
+			}
+			const float splitLo = std::max(strip.lo, strip.minY);
+			const float splitHi = std::min(strip.hi, strip.maxY);
+			if (strip.numSegments <= capacity_ || !canSplit || !(splitLo < splitHi) || 2 * strip.numSpanning >= capacity_){
+				search_(strip);
+				return;
+			}
+
+			const unsigned int numStrips = getNumStrips_(strip.numSegments);
+			vector<Strip_> strips;
+			{
+				Partition_ partition(tempDir_, strip.lo, strip.hi, splitLo, splitHi, numStrips, getBufferSize_(numStrips));
+				if (!partition.isOpen()){
+					writeFailed_ = true;
+					return;
+				}
+				ifstream inFile(strip.filePath, ios::binary);
+				vector<SegmentCoords> chunk(std::clamp<size_t>(settings_.memoryBudget / (WRITE_BUFFER_DIVISOR * sizeof(SegmentCoords)),
+															   1024, 65536));
+				size_t numLeft = strip.numSegments;
+				while (numLeft > 0){
+					const size_t n = std::min(numLeft, chunk.size());
+					inFile.read(reinterpret_cast<char*>(chunk.data()), static_cast<streamsize>(n * sizeof(SegmentCoords)));
+					if (static_cast<size_t>(inFile.gcount()) != n * sizeof(SegmentCoords)){
+						writeFailed_ = true;
+						return;
+					}
+					for (size_t k=0; k<n; k++){
+						partition.add(chunk[k]);
+					}
+					numLeft -= n;
+				}
+				if (!partition.close(strips)){
+					writeFailed_ = true;
+					return;
+				}
+			}
+			error_code ec;
+			filesystem::remove(strip.filePath, ec);
+			for (const Strip_& subStrip : strips){
+				process_(subStrip, subStrip.numSegments < strip.numSegments);
+				if (writeFailed_){
+					return;
+				}
+			}
+		}
+
+	public:
+
+		OutOfCoreSearch_(const OutOfCoreSettings& settings, const string& outFilePath)
+			:	settings_(settings),
+				tempDir_(settings.tempDirectory),
+				out_(outFilePath),
+				stats_(),
+				capacity_(std::max<size_t>(settings.memoryBudget / BYTES_PER_STRIP_SEGMENT, 1)),
+				partition_(),
+				writeFailed_(false)
+		{}
+
+		inline bool isOutputOpen(void) const{
+			return out_.isOpen();
+		}
+
+		inline bool isTempDirectoryCreated(void) const{
+			return tempDir_.isCreated();
+		}
+
+		inline bool hasWriteFailed(void) const{
+			return writeFailed_;
+		}
+
+		inline const OutOfCoreStats& getStats(void) const{
+			return stats_;
+		}
+
+		/**	Path of a temporary file, deleted with the others at the end of the search */
+		inline string makeTempFilePath(void){
+			return tempDir_.makeFilePath();
+		}
+
+		/**	Starts the first partition
+		 *	@param ymin, ymax	the y bounds of the world, over which the strips are spread
+		 *	@param numSegments	estimate of the number of segments that will be added
+		 */
+		void begin(float ymin, float ymax, size_t numSegments){
+			const unsigned int numStrips = (ymin < ymax) ? getNumStrips_(numSegments) : 1;
+			partition_ = make_unique<Partition_>(tempDir_, -numeric_limits<float>::infinity(),
+												 numeric_limits<float>::infinity(), ymin, ymax, numStrips,
+												 getBufferSize_(numStrips));
+			writeFailed_ = !partition_->isOpen();
+		}
+
+		inline bool hasBegun(void) const{
+			return partition_ != nullptr;
+		}
+
+		inline void add(const SegmentCoords& seg){
+			partition_->add(seg);
+			stats_.numSegments++;
+		}
+
+		/**	Searches all the strips, and closes the output file */
+		void finish(void){
+			out_.write("#====================================\n"
+					   "#  Segment Intersections\n"
+					   "#====================================\n\n"
+					   "#  Intersection List\n#-------------------\n");
+			if (partition_ != nullptr && !writeFailed_){
+				vector<Strip_> strips;
+				writeFailed_ = !partition_->close(strips);
+				partition_.reset();
+				for (const Strip_& strip : strips){
+					if (writeFailed_){
+						break;
+					}
+					process_(strip, true);
+				}
+			}
+			writeFailed_ = !out_.close() || writeFailed_;
+		}
+};
+
+/**	Reader of a text scene file that writes the points to a temporary file, maps it once
+ *	the segments start, and adds the segments to the search as they are read
+ */
+class TextInput_ final : public SceneFileHandler{
+
+	private:
+
+		/**	Bytes of text per segment, to estimate the number of segments from the size of the file */
+		static constexpr size_t BYTES_PER_SEGMENT_LINE = 16;
+
+		OutOfCoreSearch_& search_;
+		size_t fileSize_;
+		float ymin_, ymax_;
+		string pointsFilePath_;
+		unique_ptr<BufferedWriter> pointsFile_;
+		unique_ptr<MappedFile> pointsMap_;
+		span<const PointStruct> points_;
+		bool writeFailed_;
+
+	public:
+
+		TextInput_(OutOfCoreSearch_& search, size_t fileSize)
+			:	search_(search),
+				fileSize_(fileSize),
+				ymin_(0.f),
+				ymax_(0.f),
+				pointsFilePath_(search.makeTempFilePath()),
+				pointsFile_(make_unique<BufferedWriter>(pointsFilePath_)),
+				pointsMap_(),
+				points_(),
+				writeFailed_(false)
+		{}
+
+		inline bool isOpen(void) const{
+			return pointsFile_->isOpen();
+		}
+
+		inline bool hasWriteFailed(void) const{
+			return writeFailed_;
+		}
+
+		void setWorldBounds(float , float , float ymin, float ymax) override{
+			ymin_ = ymin;
+			ymax_ = ymax;
+		}
+
+		void addPoint(float x, float y) override{
+			const PointStruct pt(x, y);
+			pointsFile_->write(&pt, sizeof(PointStruct));
+		}
+
+		void addSegment(unsigned int index1, unsigned int index2) override{
+			if (writeFailed_){
+				return;
+			}
+			if (!search_.hasBegun()){
+				//	all the points have been read
+				if (!pointsFile_->close()){
+					writeFailed_ = true;
+					return;
+				}
+				pointsMap_ = make_unique<MappedFile>(pointsFilePath_);
+				const string_view contents = pointsMap_->getText();
+				points_ = span<const PointStruct>(reinterpret_cast<const PointStruct*>(contents.data()),
+												  contents.size() / sizeof(PointStruct));
+				search_.begin(ymin_, ymax_, fileSize_ / BYTES_PER_SEGMENT_LINE);
+			}
+			search_.add(makeCoords_(points_[index1], points_[index2], static_cast<unsigned int>(search_.getStats().numSegments)));
+		}
+};
+
+SceneFileStatus geometry::findAllIntersectionsOutOfCore(const string& sceneFilePath, const string& outFilePath,
+														const OutOfCoreSettings& settings, SceneFileError& error,
+														OutOfCoreStats* stats){
+	OutOfCoreSearch_ search(settings, outFilePath);
+	if (!search.isOutputOpen()){
+		return setError_(error, SceneFileStatus::WRITE_FAILED, "Could not create file: " + outFilePath);
+	}
+	if (!search.isTempDirectoryCreated()){
+		return setError_(error, SceneFileStatus::WRITE_FAILED, "Could not create a temporary directory in: " +
+						 (settings.tempDirectory.empty() ? string("the system's temporary directory") : settings.tempDirectory));
+	}
+
+	if (isBinarySceneFile(sceneFilePath)){
+		BinarySceneFile file;
+		const SceneFileStatus status = file.open(sceneFilePath, error);
+		if (status != SceneFileStatus::OK){
+			return status;
+		}
+		const span<const PointStruct> points = file.getPoints();
+		const span<const pair<unsigned int, unsigned int> > segments = file.getSegments();
+		search.begin(file.getYmin(), file.getYmax(), segments.size());
+		for (size_t k=0; k<segments.size(); k++){
+			search.add(makeCoords_(points[segments[k].first], points[segments[k].second], static_cast<unsigned int>(k)));
+		}
+	}else{
+		error_code ec;
+		const uintmax_t fileSize = filesystem::file_size(sceneFilePath, ec);
+		TextInput_ input(search, ec ? 0 : static_cast<size_t>(fileSize));
+		if (!input.isOpen()){
+			return setError_(error, SceneFileStatus::WRITE_FAILED, "Could not create a temporary file");
+		}
+		const SceneFileStatus status = streamSceneFile(sceneFilePath, input, error);
+		if (status != SceneFileStatus::OK){
+			return status;
+		}
+		if (input.hasWriteFailed()){
+			return setError_(error, SceneFileStatus::WRITE_FAILED, "Could not write the points to a temporary file");
+		}
+	}
+
+	search.finish();
+	if (stats != nullptr){
+		*stats = search.getStats();
+	}
+	if (search.hasWriteFailed()){
+		return setError_(error, SceneFileStatus::WRITE_FAILED, "Could not write the intersections to: " + outFilePath +
+						 "\n\t(or the temporary files of the search)");
+	}
+	return SceneFileStatus::OK;
+}
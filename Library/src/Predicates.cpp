@@ -0,0 +1,100 @@
+//
+//  Predicates.cpp
+//
+
+#include "Predicates.hpp"
+
+using namespace geometry;
+
+/**	a + b = sum + err exactly (Knuth's two-sum) */
+static inline void twoSum_(double a, double b, double& sum, double& err){
+	sum = a + b;
+	const double bVirtual = sum - a;
+	const double aVirtual = sum - bVirtual;
+	err = (a - aVirtual) + (b - bVirtual);
+}
+
+/**	a * b = product + err exactly.  The fma computes the rounding error of the product
+ *	whatever the contraction settings of the compiler.
+ */
+static inline void twoProduct_(double a, double b, double& product, double& err){
+	product = a * b;
+	err = std::fma(a, b, -product);
+}
+
+/**	Sign of the exact sum of the terms.  Adding the terms one at a time to a nonoverlapping
+ *	expansion (Shewchuk's Grow-Expansion) keeps the sum exact, and the sign of the expansion
+ *	is the sign of its largest component.  The terms are overwritten by the expansion.
+ *	@return 1, -1, or 0
+ */
+static int sumSign_(double* terms, int numTerms){
+	int length = 0;
+	for (int t=0; t<numTerms; t++){
+		double q = terms[t];
+		for (int k=0; k<length; k++){
+			twoSum_(q, terms[k], q, terms[k]);
+		}
+		terms[length++] = q;
+	}
+	for (int k=length-1; k>=0; k--){
+		if (terms[k] > 0.0){
+			return 1;
+		}
+		if (terms[k] < 0.0){
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**	det = (ptx - p1x)(p2y - p1y) - (p2x - p1x)(pty - p1y)
+ *		= ptx*p2y - ptx*p1y - p1x*p2y - p2x*pty + p2x*p1y + p1x*pty	(the p1x*p1y terms cancel)
+ */
+int geometry::orientationExact(float p1x, float p1y, float p2x, float p2y, float ptx, float pty){
+	GEOMETRY_COUNT(EXACT_ORIENTATION_TESTS);
+	double terms[6] = {
+		static_cast<double>(ptx) * p2y,
+		-static_cast<double>(ptx) * p1y,
+		-static_cast<double>(p1x) * p2y,
+		-static_cast<double>(p2x) * pty,
+		static_cast<double>(p2x) * p1y,
+		static_cast<double>(p1x) * pty
+	};
+	return sumSign_(terms, 6);
+}
+
+/**	Expanded, the determinant is the sum of sixteen products c1 * c2 * c3 of coordinates.
+ *	c1 * c2 is exact in double, and its product by c3 is exact as two doubles.
+ */
+int geometry::lineOrderExact(float ux1, float uy1, float lx1, float ly1, float ux2, float uy2, float lx2, float ly2,
+							 float y){
+	const float monomials[16][4] = {
+		{-1.f, ux1, ly1, uy2},	{1.f, ux1, ly1, ly2},	{1.f, ux1, uy2, y},		{-1.f, ux1, ly2, y},
+		{1.f, uy1, lx1, uy2},	{-1.f, uy1, lx1, ly2},	{1.f, uy1, ux2, ly2},	{-1.f, uy1, ux2, y},
+		{-1.f, uy1, uy2, lx2},	{1.f, uy1, lx2, y},		{-1.f, lx1, uy2, y},	{1.f, lx1, ly2, y},
+		{-1.f, ly1, ux2, ly2},	{1.f, ly1, ux2, y},		{1.f, ly1, uy2, lx2},	{-1.f, ly1, lx2, y}
+	};
+	double terms[32];
+	for (int k=0; k<16; k++){
+		const float* m = monomials[k];
+		twoProduct_(static_cast<double>(m[0]) * m[1] * m[2], m[3], terms[2*k], terms[2*k+1]);
+	}
+	return sumSign_(terms, 32);
+}
+
+/**	(lx1 - ux1)(uy2 - ly2) - (lx2 - ux2)(uy1 - ly1)
+ *		= lx1*uy2 - lx1*ly2 - ux1*uy2 + ux1*ly2 - lx2*uy1 + lx2*ly1 + ux2*uy1 - ux2*ly1
+ */
+int geometry::slopeOrderExact(float ux1, float uy1, float lx1, float ly1, float ux2, float uy2, float lx2, float ly2){
+	double terms[8] = {
+		static_cast<double>(lx1) * uy2,
+		-static_cast<double>(lx1) * ly2,
+		-static_cast<double>(ux1) * uy2,
+		static_cast<double>(ux1) * ly2,
+		-static_cast<double>(lx2) * uy1,
+		static_cast<double>(lx2) * ly1,
+		static_cast<double>(ux2) * uy1,
+		-static_cast<double>(ux2) * ly1
+	};
+	return sumSign_(terms, 8);
+}
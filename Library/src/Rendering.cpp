@@ -0,0 +1,224 @@
+//
+//  Rendering.cpp
+//
+//	OpenGL rendering of the points and segments, only built with GEOMETRY_RENDERING
+//	(see Point.hpp), so that the rest of the library doesn't depend on OpenGL.
+//
+
+#include "Point.hpp"
+
+#if GEOMETRY_RENDERING
+
+#include <memory>
+#include <cmath>
+#include "Segment.hpp"
+#include "Scene.hpp"
+#include "SegmentSoA.hpp"
+
+using namespace std;
+using namespace geometry;
+
+//Static variables redeclared in source code
+float Point::pointDiskRadius_;
+GLuint Point::diskList_ = 0;
+GLuint Point::circleList_ = 0;
+bool Point::displayListsInitialized_ = false;
+
+#define NUM_CIRCLE_PTS	12
+
+const GLfloat POINT_COLOR[][4] = {
+								{0.f, 0.8f, 0.8f, 1.f},	//	SINGLE_POINT,
+								{1.f, 0.5f, 0.f, 1.f},	//	ENDPOINT,
+								{1.f, 1.f, 0.f, 1.f},	//	FIRST_ENDPOINT,
+								{1.f, 0.f, 1.f, 1.f},	//	EDIT_POINT
+								{0.f, 1.f, 0.f, 1.f}	//	INTERSECTION_POINT
+};
+
+const GLfloat SEGMENT_COLOR[][4] = {
+									{1.f, 1.f, 1.f, 1.f},	//	SEGMENT,
+									{0.7f, 1.f, 0.7f, 1.f},	//	CREATED_SEGMENT,
+									{0.f, 0.f, 1.f, 1.f}	//	EDITED_SEGMENT
+};
+
+#if 0
+//-----------------------------------------------------------------
+#pragma mark -
+#pragma mark Point rendering
+//-----------------------------------------------------------------
+#endif
+
+void Point::render(PointType type) const{
+	if (!Point::displayListsInitialized_){
+		Point::initDisplayLists_();
+	}
+	switch (type){
+		using enum PointType;
+		
+		case SINGLE_POINT:
+			glColor4fv(POINT_COLOR[0]);
+			break;
+
+		case ENDPOINT:
+			glColor4fv(POINT_COLOR[1]);
+			break;
+		
+		case FIRST_ENDPOINT:
+			glColor4fv(POINT_COLOR[2]);
+			break;
+		
+		case EDIT_POINT:
+			glColor4fv(POINT_COLOR[3]);
+			break;
+		
+		default:
+			break;
+	}
+	
+	glPushMatrix();
+	glTranslatef(x_, y_, 0.f);
+	glScalef(pointDiskRadius_, pointDiskRadius_, 1.f);
+	glCallList(diskList_);
+	glFlush();
+	glPopMatrix();
+}
+
+void Point::render(const PointStruct& pt, PointType type){
+	if (!Point::displayListsInitialized_){
+		Point::initDisplayLists_();
+	}
+	
+	switch (type){
+		using enum PointType;
+		
+		case SINGLE_POINT:
+			glColor4fv(POINT_COLOR[0]);
+			break;
+
+		case ENDPOINT:
+			glColor4fv(POINT_COLOR[1]);
+			break;
+		
+		case FIRST_ENDPOINT:
+			glColor4fv(POINT_COLOR[2]);
+			break;
+		
+		case EDIT_POINT:
+			glColor4fv(POINT_COLOR[3]);
+			break;
+		
+		case INTERSECTION_POINT:
+			glColor4fv(POINT_COLOR[4]);
+			break;
+		
+		default:
+			break;
+	}
+	
+	glPushMatrix();
+	glTranslatef(pt.x, pt.y, 0.f);
+	glScalef(pointDiskRadius_, pointDiskRadius_, 1.f);
+	glCallList(diskList_);
+	glFlush();
+	glPopMatrix();
+}
+
+void Point::renderAllSinglePoints(void){
+	for (auto& pt : Scene::getDefault().getAllPoints()){
+		if (pt->isSingle()){
+			pt->render(PointType::SINGLE_POINT);
+		}
+	}
+}
+
+void Point::setPointDiskRadius(float radius){
+	pointDiskRadius_ = radius;
+}
+
+void Point::initDisplayLists_(void){
+	Point::diskList_ = glGenLists(1);
+	glNewList(Point::diskList_, GL_COMPILE);
+		glBegin(GL_POLYGON);
+			for (size_t k=0; k<NUM_CIRCLE_PTS; k++){
+				glVertex2f( static_cast<GLfloat>(cos(2.f*M_PI*k/NUM_CIRCLE_PTS)),
+							static_cast<GLfloat>(sin(2.f*M_PI*k/NUM_CIRCLE_PTS)));
+			}
+		glEnd();
+	glEndList();
+
+	Point::circleList_ = glGenLists(1);
+	glNewList(Point::circleList_, GL_COMPILE);
+		glBegin(GL_LINE_LOOP);
+			for (size_t k=0; k<NUM_CIRCLE_PTS; k++){
+				glVertex2f( static_cast<GLfloat>(cos(2.f*M_PI*k/NUM_CIRCLE_PTS)),
+							static_cast<GLfloat>(sin(2.f*M_PI*k/NUM_CIRCLE_PTS)));
+			}
+		glEnd();
+	glEndList();
+	
+	Point::displayListsInitialized_ = true;
+}
+
+#if 0
+//-----------------------------------------------------------------
+#pragma mark -
+#pragma mark Segment rendering
+//-----------------------------------------------------------------
+#endif
+
+void Segment::render(SegmentType type) const{
+	/**	first draw the segment, then draw its endpoints*/
+	render_(*p1_, *p2_, type);
+	p1_->render(PointType::ENDPOINT);
+	p2_->render(PointType::ENDPOINT);
+}
+
+void Segment::render_(const Point& pt1, const Point& pt2, SegmentType type){
+	switch (type){
+		using enum SegmentType;
+		
+		case SEGMENT:
+			glColor4fv(SEGMENT_COLOR[0]);
+			break;
+
+		case EDITED_SEGMENT:
+			glColor4fv(SEGMENT_COLOR[2]);
+			break;
+		
+		default:
+			break;
+	}
+	
+	glBegin(GL_LINES);
+		glVertex2f(pt1.getX(), pt1.getY());
+		glVertex2f(pt2.getX(), pt2.getY());
+	glEnd();
+}
+
+void Segment::renderCreated(const PointStruct& pt1, const PointStruct& pt2){
+	glColor4fv(SEGMENT_COLOR[1]);
+	
+	glBegin(GL_LINES);
+		glVertex2f(pt1.x, pt1.y);
+		glVertex2f(pt2.x, pt2.y);
+	glEnd();
+
+	Point::render(pt1, PointType::FIRST_ENDPOINT);
+}
+
+void Segment::renderAllSegments(void){
+	/**	Draw all the segments in one go, from the packed snapshot, then their endpoints */
+	const shared_ptr<const SegmentSoA> soa = SegmentSoA::getSnapshot();
+	glColor4fv(SEGMENT_COLOR[0]);
+	glBegin(GL_LINES);
+	for (size_t k=0; k<soa->size(); k++){
+		glVertex2f(soa->x1()[k], soa->y1()[k]);
+		glVertex2f(soa->x2()[k], soa->y2()[k]);
+	}
+	glEnd();
+	for (const auto& seg : Scene::getDefault().getAllSegments()) {
+		seg->p1_->render(PointType::ENDPOINT);
+		seg->p2_->render(PointType::ENDPOINT);
+	}
+}
+
+#endif	//	GEOMETRY_RENDERING
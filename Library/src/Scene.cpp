@@ -0,0 +1,304 @@
+//
+//  Scene.cpp
+//
+
+#include <algorithm>
+#include <memory>
+#include <cmath>
+#include <limits>
+#include <climits>
+#include "Geometry.hpp"
+#include "Scene.hpp"
+#include "SegmentGrid.hpp"
+#include "SegmentSoA.hpp"
+#include "Counters.hpp"
+
+using namespace std;
+using namespace geometry;
+
+Scene::Scene(void)
+	:	pointVect_(),
+		pointArena_(make_shared<Arena>()),
+		pointGrid_(ArenaAllocator<PointGrid_::value_type>(pointArena_)),
+		gridCellSize_(1.f),
+		pointVersion_(0),
+		segVect_(),
+		segArena_(make_shared<Arena>()),
+		segIndex_(ArenaAllocator<SegIndex_::value_type>(segArena_)),
+		segVersion_(0),
+		incremental_(false),
+		liveIntersections_(),
+		liveIndex_(),
+		livePointVersion_(0),
+		indexCellSize_(1.f),
+		snapshot_(),
+		snapshotSegVersion_(0),
+		snapshotPointVersion_(0)
+{
+}
+
+Scene::~Scene(void){
+	incremental_ = false;
+	clearAllSegments();
+	clearAllPoints();
+}
+
+Scene& Scene::getDefault(void){
+	static Scene defaultScene;
+	return defaultScene;
+}
+
+#if 0
+//-----------------------------------------------------------------
+#pragma mark -
+#pragma mark Points
+//-----------------------------------------------------------------
+#endif
+
+shared_ptr<Point> Scene::makeNewPointPtr(float xCoord, float yCoord){
+	return pointVect_[findOrAddPoint_(xCoord, yCoord)];
+}
+
+Point& Scene::makeNewPoint(float xCoord, float yCoord){
+	return *pointVect_[findOrAddPoint_(xCoord, yCoord)];
+}
+
+PointId Scene::makeNewPointId(float xCoord, float yCoord){
+	return PointId{findOrAddPoint_(xCoord, yCoord)};
+}
+
+void Scene::makeNewPointIds(span<const PointStruct> coords, vector<PointId>& ids){
+	pointVect_.reserve(pointVect_.size() + coords.size());
+	pointGrid_.reserve(pointGrid_.size() + coords.size());
+	ids.reserve(ids.size() + coords.size());
+	for (const PointStruct& pt : coords){
+		ids.push_back(PointId{findOrAddPoint_(pt.x, pt.y)});
+	}
+}
+
+unsigned int Scene::findOrAddPoint_(float xCoord, float yCoord){
+	/** First check if the point exists or not, if it is return its index otherwise make the new point*/
+	const unsigned int idx = findPoint_(xCoord, yCoord);
+	if (idx != UINT_MAX){
+		return idx;
+	}else{
+		const unsigned int newIdx = static_cast<unsigned int>(pointVect_.size());
+		pointVect_.push_back(newPoint_(pointArena_, newIdx, xCoord, yCoord));
+		addToGrid_(*pointVect_.back());
+		return newIdx;
+	}
+}
+
+void Scene::clearAllPoints(void){
+	pointGrid_.clear();
+	pointVect_.clear();
+	pointArena_ = make_shared<Arena>();
+	pointGrid_ = PointGrid_(ArenaAllocator<PointGrid_::value_type>(pointArena_));
+	pointVersion_++;
+}
+
+shared_ptr<Point> Scene::newPoint_(const shared_ptr<Arena>& arena, unsigned int idx, float xCoord, float yCoord){
+	return allocate_shared<Point>(ArenaAllocator<Point>(arena), PointToken{}, *this, idx, xCoord, yCoord);
+}
+
+int32_t Scene::gridCell_(float v) const{
+	double c = floor(static_cast<double>(v) / gridCellSize_);
+	if (c < numeric_limits<int32_t>::min()){
+		c = numeric_limits<int32_t>::min();
+	}else if (c > numeric_limits<int32_t>::max()){
+		c = numeric_limits<int32_t>::max();
+	}
+	return static_cast<int32_t>(c);
+}
+
+void Scene::addToGrid_(const Point& pt){
+	pointGrid_.emplace(gridKey_(gridCell_(pt.x_), gridCell_(pt.y_)), pt.idx_);
+}
+
+void Scene::movePoint_(Point& pt, float x, float y){
+	const uint64_t oldKey = gridKey_(gridCell_(pt.x_), gridCell_(pt.y_));
+	const uint64_t newKey = gridKey_(gridCell_(x), gridCell_(y));
+	if (oldKey != newKey){
+		auto cell = pointGrid_.equal_range(oldKey);
+		for (auto iter = cell.first; iter != cell.second; iter++){
+			if (iter->second == pt.idx_){
+				pointGrid_.erase(iter);
+				pointGrid_.emplace(newKey, pt.idx_);
+				break;
+			}
+		}
+	}
+	pt.x_ = x;
+	pt.y_ = y;
+	pointVersion_++;
+}
+
+/**	Two points are the same only if they have exactly the same coordinates (as
+ *	the points of the scene used to be looked up), so only the cell of (x, y) is searched.
+ */
+unsigned int Scene::findPoint_(float xCoord, float yCoord) const{
+	//	the points of a cell come in no particular order: return the oldest match
+	unsigned int found = UINT_MAX;
+	auto cell = pointGrid_.equal_range(gridKey_(gridCell_(xCoord), gridCell_(yCoord)));
+	for (auto iter = cell.first; iter != cell.second; iter++){
+		GEOMETRY_COUNT(POINT_REGISTRY_PROBES);
+		const Point& pt = *pointVect_[iter->second];
+		if (iter->second < found && pt.x_ == xCoord && pt.y_ == yCoord){
+			found = iter->second;
+		}
+	}
+	return found;
+}
+
+void Scene::setGridCellSize(float size){
+	if (size <= 0.f || size == gridCellSize_){
+		return;
+	}
+	gridCellSize_ = size;
+	pointGrid_.clear();
+	for (auto& pt : pointVect_){
+		addToGrid_(*pt);
+	}
+}
+
+#if 0
+//-----------------------------------------------------------------
+#pragma mark -
+#pragma mark Segments
+//-----------------------------------------------------------------
+#endif
+
+shared_ptr<Segment> Scene::makeNewSegPtr(const shared_ptr<Point>& pt1, const shared_ptr<Point>& pt2){
+	return segVect_[findOrAddSegment_(pt1, pt2)];
+}
+
+Segment& Scene::makeNewSeg(const shared_ptr<Point>& pt1, const shared_ptr<Point>& pt2){
+	return *segVect_[findOrAddSegment_(pt1, pt2)];
+}
+
+SegmentId Scene::makeNewSegId(PointId pt1, PointId pt2){
+	return SegmentId{findOrAddSegment_(pointVect_[pt1.idx], pointVect_[pt2.idx])};
+}
+
+void Scene::makeNewSegIds(span<const pair<unsigned int, unsigned int> > ends, span<const PointId> points){
+	segVect_.reserve(segVect_.size() + ends.size());
+	segIndex_.reserve(segIndex_.size() + ends.size());
+	const bool incremental = incremental_;
+	incremental_ = false;
+	for (const auto& end : ends){
+		findOrAddSegment_(pointVect_[points[end.first].idx], pointVect_[points[end.second].idx]);
+	}
+	incremental_ = incremental;
+	if (incremental_){
+		rebuildLiveIntersections_();
+	}
+}
+
+unsigned int Scene::findOrAddSegment_(const shared_ptr<Point>& pt1, const shared_ptr<Point>& pt2){
+	/** segIndex_ is keyed on the endpoint pair, so (pt1, pt2) and (pt2, pt1) find the same segment */
+	const uint64_t key = endpointKey_(pt1->idx_, pt2->idx_);
+	GEOMETRY_COUNT(SEGMENT_REGISTRY_PROBES);
+	auto iter = segIndex_.find(key);
+	if (iter != segIndex_.end()){
+		/**return the index of the segment*/
+		return iter->second;
+	}else{
+		const unsigned int newIdx = static_cast<unsigned int>(segVect_.size());
+		segVect_.push_back(newSegment_(segArena_, newIdx, pt1, pt2));
+		segIndex_.emplace(key, newIdx);
+		segVersion_++;
+		/** If points were moved, the live intersections will be rebuilt anyway */
+		if (incremental_ && livePointVersion_ == pointVersion_){
+			addLiveIntersections_(*segVect_.back());
+		}
+		return newIdx;
+	}
+}
+
+shared_ptr<Segment> Scene::newSegment_(const shared_ptr<Arena>& arena, unsigned int idx,
+									   const shared_ptr<Point>& pt1, const shared_ptr<Point>& pt2){
+	return allocate_shared<Segment>(ArenaAllocator<Segment>(arena), SegmentToken{}, idx, pt1, pt2);
+}
+
+void Scene::clearAllSegments(void){
+	segIndex_.clear();
+	segVect_.clear();
+	segArena_ = make_shared<Arena>();
+	segIndex_ = SegIndex_(ArenaAllocator<SegIndex_::value_type>(segArena_));
+	segVersion_++;
+	if (incremental_){
+		rebuildLiveIntersections_();
+	}
+}
+
+shared_ptr<const SegmentSoA> Scene::getSnapshot(void){
+	if (snapshot_ == nullptr || snapshotSegVersion_ != segVersion_ || snapshotPointVersion_ != pointVersion_){
+		snapshot_ = make_shared<const SegmentSoA>(segVect_);
+		snapshotSegVersion_ = segVersion_;
+		snapshotPointVersion_ = pointVersion_;
+	}
+	return snapshot_;
+}
+
+#if 0
+//-----------------------------------------------------------------
+#pragma mark -
+#pragma mark Incremental intersections
+//-----------------------------------------------------------------
+#endif
+
+void Scene::setIncrementalIntersections(bool on){
+	incremental_ = on;
+	if (on){
+		rebuildLiveIntersections_();
+	}else{
+		liveIntersections_.clear();
+		liveIndex_.reset();
+	}
+}
+
+const vector<IntersectionRecord>& Scene::getLiveIntersections(void){
+	if (incremental_ && livePointVersion_ != pointVersion_){
+		rebuildLiveIntersections_();
+	}
+	return liveIntersections_;
+}
+
+void Scene::setIndexCellSize(float size){
+	indexCellSize_ = size;
+	if (incremental_){
+		rebuildLiveIntersections_();
+	}
+}
+
+void Scene::rebuildLiveIntersections_(void){
+	findAllIntersectionsGrid(segVect_, liveIntersections_);
+	liveIndex_ = make_unique<SegmentHashGrid>(indexCellSize_);
+	for (size_t k=0; k<segVect_.size(); k++){
+		const Segment& seg = *segVect_[k];
+		liveIndex_->insert(static_cast<unsigned int>(k), seg.p1_->x_, seg.p1_->y_, seg.p2_->x_, seg.p2_->y_);
+	}
+	livePointVersion_ = pointVersion_;
+}
+
+/**	The segments are stored in the index by position in segVect_.  The intersection of an
+ *	older segment and the new one is computed as a point of the older segment, like in the
+ *	findAllIntersections* functions, so we get the same points as a full recompute.
+ */
+void Scene::addLiveIntersections_(const Segment& seg){
+	const float x1 = seg.p1_->x_, y1 = seg.p1_->y_, x2 = seg.p2_->x_, y2 = seg.p2_->y_;
+	vector<unsigned int> candidates;
+	liveIndex_->forEachCandidate(x1, y1, x2, y2, [&](unsigned int k){
+		candidates.push_back(k);
+	});
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	PointStruct interPt;
+	for (unsigned int k : candidates){
+		const Segment& other = *segVect_[k];
+		if (other.findIntersection(seg, interPt)){
+			liveIntersections_.push_back(IntersectionRecord{interPt.x, interPt.y, other.idx_, seg.idx_});
+		}
+	}
+	liveIndex_->insert(static_cast<unsigned int>(segVect_.size() - 1), x1, y1, x2, y2);
+}
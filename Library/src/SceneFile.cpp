@@ -0,0 +1,872 @@
+//
+//  SceneFile.cpp
+//
+
+#include <charconv>
+#include <cstring>
+#include <climits>
+#include <bit>
+#include <fstream>
+#include <algorithm>
+#include <type_traits>
+#include <thread>
+#include <atomic>
+
+#include "SceneFile.hpp"
+#include "MappedFile.hpp"
+#include "BufferedWriter.hpp"
+#include "Scene.hpp"
+
+using namespace std;
+using namespace geometry;
+
+#if 0
+//-----------------------------------------------------------------
+#pragma mark -
+#pragma mark Parsing
+//-----------------------------------------------------------------
+#endif
+
+static inline bool isBlank_(char c){
+	return c == ' ' || c == '\t';
+}
+
+/**	Extracts the next line of text (without its end of line) starting at pos, and moves pos past it.
+ *	@return false at the end of the text
+ */
+static inline bool nextLine_(string_view text, size_t& pos, string_view& line){
+	if (pos >= text.size()){
+		return false;
+	}
+	const char* start = text.data() + pos;
+	const char* end = static_cast<const char*>(memchr(start, '\n', text.size() - pos));
+	size_t length = (end != nullptr) ? static_cast<size_t>(end - start) : text.size() - pos;
+	pos += length + 1;
+	//	files saved on Windows
+	if (length > 0 && start[length-1] == '\r'){
+		length--;
+	}
+	line = string_view(start, length);
+	return true;
+}
+
+/**	Lines of a text in memory
+ */
+class TextLines_{
+
+	private:
+
+		string_view text_;
+		size_t pos_;
+
+	public:
+
+		explicit TextLines_(string_view text)
+			:	text_(text),
+				pos_(0)
+		{}
+
+		inline bool next(string_view& line){
+			return nextLine_(text_, pos_, line);
+		}
+
+		/**	Position of the next line in the text */
+		inline size_t getPosition(void) const{
+			return std::min(pos_, text_.size());
+		}
+};
+
+/**	Lines of a file read by chunks, so that files of any size can be parsed in
+ *	bounded memory.  A line stays valid until the next call to next().
+ */
+class FileLines_{
+
+	private:
+
+		static constexpr size_t CHUNK_SIZE = 1 << 20;
+
+		ifstream inFile_;
+		vector<char> buffer_;
+		//	the characters not read yet are [pos_, end_) of buffer_
+		size_t pos_;
+		size_t end_;
+		bool atEnd_;
+
+	public:
+
+		explicit FileLines_(const string& filePath)
+			:	inFile_(filePath, ios::binary),
+				buffer_(CHUNK_SIZE),
+				pos_(0),
+				end_(0),
+				atEnd_(false)
+		{}
+
+		inline bool isOpen(void) const{
+			return inFile_.is_open();
+		}
+
+		bool next(string_view& line){
+			while (true){
+				const string_view rest(buffer_.data() + pos_, end_ - pos_);
+				if (atEnd_ || memchr(rest.data(), '\n', rest.size()) != nullptr){
+					size_t pos = 0;
+					if (!nextLine_(rest, pos, line)){
+						return false;
+					}
+					pos_ = std::min(pos_ + pos, end_);
+					return true;
+				}
+				//	move the partial line to the front of the buffer (growing it for a very long line), and read more
+				std::copy(buffer_.begin() + static_cast<ptrdiff_t>(pos_), buffer_.begin() + static_cast<ptrdiff_t>(end_),
+						  buffer_.begin());
+				end_ -= pos_;
+				pos_ = 0;
+				if (end_ == buffer_.size()){
+					buffer_.resize(2 * buffer_.size());
+				}
+				inFile_.read(buffer_.data() + end_, static_cast<streamsize>(buffer_.size() - end_));
+				const size_t numRead = static_cast<size_t>(inFile_.gcount());
+				end_ += numRead;
+				atEnd_ = (numRead == 0 || !inFile_);
+			}
+		}
+};
+
+/**	Extracts the next line that is neither blank nor a comment, starting at its first non-blank character
+ *	@return false at the end of the text
+ */
+template <typename Lines>
+static bool nextDataLine_(Lines& lines, size_t& lineNumber, string_view& line){
+	while (lines.next(line)){
+		lineNumber++;
+		size_t k = 0;
+		while (k < line.size() && isBlank_(line[k])){
+			k++;
+		}
+		if (k < line.size() && line[k] != '#'){
+			line.remove_prefix(k);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**	Removes the next blank-separated word from a line and returns it (empty if there is none) */
+static inline string_view nextWord_(string_view& line){
+	size_t start = 0;
+	while (start < line.size() && isBlank_(line[start])){
+		start++;
+	}
+	size_t end = start;
+	while (end < line.size() && !isBlank_(line[end])){
+		end++;
+	}
+	const string_view word = line.substr(start, end - start);
+	line.remove_prefix(end);
+	return word;
+}
+
+/**	Parses a whole word as a number.  Like the stream operators, accepts a leading + sign.
+ */
+template <typename T>
+static inline bool parseNumber_(string_view word, T& val){
+	const char* first = word.data();
+	const char* last = first + word.size();
+	if (first != last && *first == '+'){
+		first++;
+	}
+	const from_chars_result result = from_chars(first, last, val);
+	return result.ec == errc() && result.ptr == last;
+}
+
+/**	Parses a point record: p|v <float> <float>
+ */
+static inline bool parsePoint_(string_view line, float& x, float& y){
+	const string_view word = nextWord_(line);
+	return word.size() == 1 && parseNumber_(nextWord_(line), x) && parseNumber_(nextWord_(line), y);
+}
+
+/**	Parses a segment record: s <point index> <point index>
+ */
+static inline bool parseSegment_(string_view line, unsigned int& index1, unsigned int& index2){
+	const string_view word = nextWord_(line);
+	return word.size() == 1 && parseNumber_(nextWord_(line), index1) && parseNumber_(nextWord_(line), index2);
+}
+
+/**	Parses an intersection record: i <float> <float> <segment index> <segment index>
+ */
+static inline bool parseIntersection_(string_view line, IntersectionRecord& inter){
+	const string_view word = nextWord_(line);
+	return word.size() == 1 && parseNumber_(nextWord_(line), inter.x) && parseNumber_(nextWord_(line), inter.y) &&
+		parseNumber_(nextWord_(line), inter.segA) && parseNumber_(nextWord_(line), inter.segB);
+}
+
+static SceneFileStatus setError_(SceneFileError& error, SceneFileStatus status, size_t lineNumber, string message){
+	error.status = status;
+	error.lineNumber = lineNumber;
+	error.message = std::move(message);
+	return status;
+}
+
+/**	Parses the world bounds that start a scene file
+ *	@param bounds	receives xmin, xmax, ymin and ymax
+ */
+template <typename Lines>
+static SceneFileStatus parseWorldBounds_(Lines& lines, size_t& lineNumber, float bounds[4], SceneFileError& error){
+	string_view line;
+	const char* const LABELS[] = {"XMIN", "XMAX", "YMIN", "YMAX"};
+	for (int k=0; k<4; k++){
+		const bool found = nextDataLine_(lines, lineNumber, line);
+		if (!found){
+			line = string_view();
+		}
+		string_view words = line;
+		const string_view label = nextWord_(words);
+		const string_view eqStr = nextWord_(words);
+		if (!found || label != LABELS[k] || eqStr != "=" || !parseNumber_(nextWord_(words), bounds[k])){
+			return setError_(error, SceneFileStatus::INVALID_WORLD_BOUND, found ? lineNumber : 0,
+							 "Invalid World Bound format line: " + string(line) +
+							 "\n\tExpected format: " + LABELS[k] + " = <float value>");
+		}
+		//	anything after the value is ignored
+	}
+	return SceneFileStatus::OK;
+}
+
+/**	Parses the lines of a scene file, handing the records to a handler
+ *	(with the interface of SceneFileHandler, virtual or not).
+ */
+template <typename Lines, typename Handler>
+static SceneFileStatus parseLines_(Lines& lines, Handler& handler, SceneFileError& error){
+	size_t lineNumber = 0;
+	string_view line;
+
+	//-----------------------------------------------------
+	//	Section 1:	World Bounds
+	//-----------------------------------------------------
+	float bounds[4];
+	const SceneFileStatus status = parseWorldBounds_(lines, lineNumber, bounds, error);
+	if (status != SceneFileStatus::OK){
+		return status;
+	}
+	handler.setWorldBounds(bounds[0], bounds[1], bounds[2], bounds[3]);
+
+	//-----------------------------------------------------
+	//	Section 2:	Point list
+	//-----------------------------------------------------
+	size_t numPoints = 0;
+	bool haveLine = nextDataLine_(lines, lineNumber, line);
+	while (haveLine && (line[0] == 'p' || line[0] == 'v')){
+		float x, y;
+		if (!parsePoint_(line, x, y)){
+			return setError_(error, SceneFileStatus::INVALID_RECORD, lineNumber,
+							 "Invalid Point coordinates format line: " + string(line) +
+							 "\n\tExpected format: v|p <float value> <float value>");
+		}
+		handler.addPoint(x, y);
+		numPoints++;
+		haveLine = nextDataLine_(lines, lineNumber, line);
+	}
+
+	//-----------------------------------------------------
+	//	Section 3:	Segment list
+	//-----------------------------------------------------
+	size_t numSegments = 0;
+	while (haveLine && line[0] == 's'){
+		unsigned int index1, index2;
+		if (!parseSegment_(line, index1, index2)){
+			return setError_(error, SceneFileStatus::INVALID_RECORD, lineNumber,
+							 "Invalid Segment format line: " + string(line) +
+							 "\n\tExpected format: s  <point index 1> <point index 2>");
+		}
+		if (index1 >= numPoints || index2 >= numPoints){
+			return setError_(error, SceneFileStatus::INVALID_RECORD, lineNumber,
+							 "Invalid Segment point index line: " + string(line) +
+							 "\n\tThe file defines " + to_string(numPoints) + " points");
+		}
+		handler.addSegment(index1, index2);
+		numSegments++;
+		haveLine = nextDataLine_(lines, lineNumber, line);
+	}
+
+	//-----------------------------------------------------
+	//	Section 4:	Intersection list
+	//-----------------------------------------------------
+	while (haveLine && line[0] == 'i'){
+		IntersectionRecord inter;
+		if (!parseIntersection_(line, inter) || inter.segA >= numSegments || inter.segB >= numSegments){
+			return setError_(error, SceneFileStatus::INVALID_RECORD, lineNumber,
+							 "Invalid Intersection format line: " + string(line) +
+							 "\n\tExpected format: i <float value> <float value> <segment index 1> <segment index 2>");
+		}
+		handler.addIntersection(inter);
+		haveLine = nextDataLine_(lines, lineNumber, line);
+	}
+
+	//	At this moment, the file format only defines points, segments and intersections
+	return SceneFileStatus::OK;
+}
+
+/**	Handler of parseLines_ that stores the records in a SceneFileData
+ */
+class DataHandler_{
+
+	private:
+
+		SceneFileData& data_;
+		const unsigned int firstPoint_;
+		const unsigned int firstSegment_;
+
+	public:
+
+		explicit DataHandler_(SceneFileData& data)
+			:	data_(data),
+				firstPoint_(static_cast<unsigned int>(data.points.size())),
+				firstSegment_(static_cast<unsigned int>(data.segments.size()))
+		{}
+
+		inline void setWorldBounds(float xmin, float xmax, float ymin, float ymax){
+			data_.xmin = xmin;
+			data_.xmax = xmax;
+			data_.ymin = ymin;
+			data_.ymax = ymax;
+		}
+
+		inline void addPoint(float x, float y){
+			data_.points.emplace_back(x, y);
+		}
+
+		inline void addSegment(unsigned int index1, unsigned int index2){
+			data_.segments.emplace_back(firstPoint_ + index1, firstPoint_ + index2);
+		}
+
+		inline void addIntersection(IntersectionRecord inter){
+			inter.segA += firstSegment_;
+			inter.segB += firstSegment_;
+			data_.intersections.push_back(inter);
+		}
+};
+
+#if 0
+//-----------------------------------------------------------------
+#pragma mark -
+#pragma mark Parallel parsing
+//-----------------------------------------------------------------
+#endif
+
+/**	Size of text below which a scene file is parsed by a single thread */
+#define MIN_PARALLEL_PARSE_SIZE	(size_t(1) << 20)
+
+/**	Number of chunks per thread, so that the threads that are done early take over the chunks of the others */
+#define CHUNKS_PER_THREAD	4
+
+/**	Kind of a record, in the order of the sections of the file */
+enum class RecordKind_{
+	POINT,
+	SEGMENT,
+	INTERSECTION,
+	//	a line that ends the data
+	OTHER
+};
+
+static inline RecordKind_ recordKind_(char c){
+	switch (c){
+		case 'p':
+		case 'v':
+			return RecordKind_::POINT;
+		case 's':
+			return RecordKind_::SEGMENT;
+		case 'i':
+			return RecordKind_::INTERSECTION;
+		default:
+			return RecordKind_::OTHER;
+	}
+}
+
+/**	A line-aligned chunk of the records of a scene file, and what it contains.  The
+ *	indices of its segments and intersections are positions in the file, not checked yet.
+ */
+struct ParseChunk_{
+	string_view text;
+	vector<PointStruct> points;
+	vector<pair<unsigned int, unsigned int> > segments;
+	vector<IntersectionRecord> intersections;
+	/**	Kinds of the first and last records of the chunk, if it has any */
+	bool hasRecords = false;
+	RecordKind_ firstKind = RecordKind_::POINT;
+	RecordKind_ lastKind = RecordKind_::POINT;
+	/**	true if the chunk has a line that ends the data: one that is not a record, or a
+	 *	record of an earlier section than the one before it.  The records of the chunk
+	 *	stop before that line.
+	 */
+	bool endsData = false;
+	/**	true if the chunk has an invalid record (before any line that ends the data) */
+	bool failed = false;
+};
+
+/**	Parses the records of a chunk the way parseLines_ does, except that the chunk's
+ *	section is the one of its first record
+ */
+static void parseChunk_(ParseChunk_& chunk){
+	TextLines_ lines(chunk.text);
+	size_t lineNumber = 0;
+	string_view line;
+	while (nextDataLine_(lines, lineNumber, line)){
+		const RecordKind_ kind = recordKind_(line[0]);
+		if (!chunk.hasRecords){
+			chunk.hasRecords = true;
+			chunk.firstKind = chunk.lastKind = kind;
+		}
+		if (kind == RecordKind_::OTHER || kind < chunk.lastKind){
+			chunk.endsData = true;
+			return;
+		}
+		chunk.lastKind = kind;
+		bool valid = false;
+		switch (kind){
+			case RecordKind_::POINT:{
+				float x, y;
+				valid = parsePoint_(line, x, y);
+				if (valid){
+					chunk.points.emplace_back(x, y);
+				}
+				break;
+			}
+			case RecordKind_::SEGMENT:{
+				unsigned int index1, index2;
+				valid = parseSegment_(line, index1, index2);
+				if (valid){
+					chunk.segments.emplace_back(index1, index2);
+				}
+				break;
+			}
+			default:{
+				IntersectionRecord inter;
+				valid = parseIntersection_(line, inter);
+				if (valid){
+					chunk.intersections.push_back(inter);
+				}
+				break;
+			}
+		}
+		if (!valid){
+			chunk.failed = true;
+			return;
+		}
+	}
+}
+
+/**	Runs task(k) for k in [0, numTasks) on numThreads threads */
+template <typename Task>
+static void runTasks_(unsigned int numThreads, size_t numTasks, Task&& task){
+	atomic<size_t> nextTask(0);
+	const auto worker = [&](){
+		for (size_t k = nextTask++; k < numTasks; k = nextTask++){
+			task(k);
+		}
+	};
+	vector<thread> threads;
+	for (unsigned int k=1; k<numThreads; k++){
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (auto& th : threads){
+		th.join();
+	}
+}
+
+/**	Parses the records that follow the world bounds in line-aligned chunks, on several
+ *	threads, then appends them to data in file order.
+ *	@return false if the records have an error, which is left for the sequential parser to report
+ */
+static bool parseRecordsParallel_(string_view text, SceneFileData& data, unsigned int numThreads){
+	const size_t numChunks = size_t(numThreads) * CHUNKS_PER_THREAD;
+	vector<ParseChunk_> chunks(numChunks);
+	size_t start = 0;
+	for (size_t k=0; k<numChunks; k++){
+		size_t end = text.size() * (k+1) / numChunks;
+		if (end > start && end < text.size()){
+			const char* endOfLine = static_cast<const char*>(memchr(text.data() + end, '\n', text.size() - end));
+			end = (endOfLine != nullptr) ? static_cast<size_t>(endOfLine - text.data()) + 1 : text.size();
+		}
+		end = std::max(start, end);
+		chunks[k].text = text.substr(start, end - start);
+		start = end;
+	}
+	runTasks_(numThreads, numChunks, [&chunks](size_t k){
+		parseChunk_(chunks[k]);
+	});
+
+	/**	The chunks that hold data are those until the first that ends it, or that starts with a
+	 *	record of an earlier section than the previous chunk's last
+	 */
+	RecordKind_ section = RecordKind_::POINT;
+	size_t numDataChunks = 0;
+	for (const ParseChunk_& chunk : chunks){
+		if (chunk.hasRecords && chunk.firstKind < section){
+			break;
+		}
+		numDataChunks++;
+		if (chunk.failed){
+			return false;
+		}
+		if (chunk.endsData){
+			break;
+		}
+		if (chunk.hasRecords){
+			section = chunk.lastKind;
+		}
+	}
+
+	const size_t firstPoint = data.points.size();
+	const size_t firstSegment = data.segments.size();
+	vector<size_t> pointOffsets(numDataChunks), segmentOffsets(numDataChunks), interOffsets(numDataChunks);
+	size_t numPoints = 0, numSegments = 0, numIntersections = 0;
+	for (size_t k=0; k<numDataChunks; k++){
+		pointOffsets[k] = firstPoint + numPoints;
+		segmentOffsets[k] = firstSegment + numSegments;
+		interOffsets[k] = data.intersections.size() + numIntersections;
+		numPoints += chunks[k].points.size();
+		numSegments += chunks[k].segments.size();
+		numIntersections += chunks[k].intersections.size();
+	}
+	data.points.resize(firstPoint + numPoints);
+	data.segments.resize(firstSegment + numSegments);
+	data.intersections.resize(data.intersections.size() + numIntersections);
+
+	atomic<bool> validIndices(true);
+	runTasks_(numThreads, numDataChunks, [&](size_t k){
+		ParseChunk_& chunk = chunks[k];
+		std::copy(chunk.points.begin(), chunk.points.end(), data.points.begin() + static_cast<ptrdiff_t>(pointOffsets[k]));
+		bool valid = true;
+		auto segOut = data.segments.begin() + static_cast<ptrdiff_t>(segmentOffsets[k]);
+		for (const auto& seg : chunk.segments){
+			valid = valid && seg.first < numPoints && seg.second < numPoints;
+			*segOut++ = make_pair(static_cast<unsigned int>(firstPoint + seg.first),
+								  static_cast<unsigned int>(firstPoint + seg.second));
+		}
+		auto interOut = data.intersections.begin() + static_cast<ptrdiff_t>(interOffsets[k]);
+		for (IntersectionRecord inter : chunk.intersections){
+			valid = valid && inter.segA < numSegments && inter.segB < numSegments;
+			inter.segA += static_cast<unsigned int>(firstSegment);
+			inter.segB += static_cast<unsigned int>(firstSegment);
+			*interOut++ = inter;
+		}
+		if (!valid){
+			validIndices = false;
+		}
+		//	free the chunk's buffers as we go
+		chunk = ParseChunk_();
+	});
+	return validIndices;
+}
+
+SceneFileStatus geometry::parseSceneFile(string_view text, SceneFileData& data, SceneFileError& error,
+										 unsigned int numThreads){
+	if (numThreads == 0){
+		numThreads = std::max(1U, thread::hardware_concurrency());
+	}
+	if (numThreads > 1 && text.size() >= MIN_PARALLEL_PARSE_SIZE){
+		TextLines_ lines(text);
+		size_t lineNumber = 0;
+		float bounds[4];
+		const SceneFileStatus status = parseWorldBounds_(lines, lineNumber, bounds, error);
+		if (status != SceneFileStatus::OK){
+			return status;
+		}
+		const size_t numPoints = data.points.size();
+		const size_t numSegments = data.segments.size();
+		const size_t numIntersections = data.intersections.size();
+		if (parseRecordsParallel_(text.substr(lines.getPosition()), data, numThreads)){
+			DataHandler_(data).setWorldBounds(bounds[0], bounds[1], bounds[2], bounds[3]);
+			return SceneFileStatus::OK;
+		}
+		//	let the sequential parser find the error and its line
+		data.points.resize(numPoints);
+		data.segments.resize(numSegments);
+		data.intersections.resize(numIntersections);
+	}
+	TextLines_ lines(text);
+	DataHandler_ handler(data);
+	return parseLines_(lines, handler, error);
+}
+
+SceneFileStatus geometry::readSceneFile(const string& filePath, SceneFileData& data, SceneFileError& error,
+										unsigned int numThreads){
+	const MappedFile file(filePath);
+	if (!file.isOpen()){
+		return setError_(error, SceneFileStatus::FILE_NOT_FOUND, 0, "File not found: " + filePath);
+	}
+	file.adviseSequential();
+	return parseSceneFile(file.getText(), data, error, numThreads);
+}
+
+SceneFileStatus geometry::streamSceneFile(const string& filePath, SceneFileHandler& handler, SceneFileError& error){
+	FileLines_ lines(filePath);
+	if (!lines.isOpen()){
+		return setError_(error, SceneFileStatus::FILE_NOT_FOUND, 0, "File not found: " + filePath);
+	}
+	return parseLines_(lines, handler, error);
+}
+
+#if 0
+//-----------------------------------------------------------------
+#pragma mark -
+#pragma mark Text writing
+//-----------------------------------------------------------------
+#endif
+
+/**	Writes the shortest representation that reads back as the same float */
+template <typename T>
+static inline char* writeNumber_(char* out, T val){
+	return BufferedWriter::formatNumber(out, val);
+}
+
+void geometry::writeIntersectionLine(BufferedWriter& writer, const IntersectionRecord& inter){
+	char* out = writer.reserveLine();
+	*out++ = 'i';
+	*out++ = ' ';
+	out = writeNumber_(out, inter.x);
+	*out++ = ' ';
+	out = writeNumber_(out, inter.y);
+	*out++ = ' ';
+	out = writeNumber_(out, inter.segA);
+	*out++ = ' ';
+	out = writeNumber_(out, inter.segB);
+	*out++ = '\n';
+	writer.commitLine(out);
+}
+
+SceneFileStatus geometry::writeSceneFile(const string& filePath, const SceneFileData& data, SceneFileError& error){
+	BufferedWriter writer(filePath);
+	if (!writer.isOpen()){
+		return setError_(error, SceneFileStatus::WRITE_FAILED, 0, "Could not create file: " + filePath);
+	}
+	writer.write("#====================================\n"
+				 "#  Segment Intersection Scene\n"
+				 "#====================================\n\n");
+
+	const char* const LABELS[] = {"XMIN = ", "XMAX = ", "YMIN = ", "YMAX = "};
+	const float bounds[] = {data.xmin, data.xmax, data.ymin, data.ymax};
+	for (int k=0; k<4; k++){
+		char* out = writer.reserveLine();
+		out = std::copy_n(LABELS[k], 7, out);
+		out = writeNumber_(out, bounds[k]);
+		*out++ = '\n';
+		writer.commitLine(out);
+	}
+
+	writer.write("\n#  Point List\n#------------\n");
+	for (const PointStruct& pt : data.points){
+		char* out = writer.reserveLine();
+		*out++ = 'p';
+		*out++ = ' ';
+		out = writeNumber_(out, pt.x);
+		*out++ = ' ';
+		out = writeNumber_(out, pt.y);
+		*out++ = '\n';
+		writer.commitLine(out);
+	}
+
+	writer.write("\n#  Segment List\n#--------------\n");
+	for (const auto& seg : data.segments){
+		char* out = writer.reserveLine();
+		*out++ = 's';
+		*out++ = ' ';
+		out = writeNumber_(out, seg.first);
+		*out++ = ' ';
+		out = writeNumber_(out, seg.second);
+		*out++ = '\n';
+		writer.commitLine(out);
+	}
+
+	if (!data.intersections.empty()){
+		writer.write("\n#  Intersection List\n#-------------------\n");
+		for (const IntersectionRecord& inter : data.intersections){
+			writeIntersectionLine(writer, inter);
+		}
+	}
+
+	if (!writer.close()){
+		return setError_(error, SceneFileStatus::WRITE_FAILED, 0, "Could not write file: " + filePath);
+	}
+	return SceneFileStatus::OK;
+}
+
+#if 0
+//-----------------------------------------------------------------
+#pragma mark -
+#pragma mark Binary format
+//-----------------------------------------------------------------
+#endif
+
+//	The arrays of the file are used in place
+static_assert(endian::native == endian::little, "The binary scene format is little-endian");
+static_assert(sizeof(BinarySceneHeader) == 64, "The header of the binary format has a fixed layout");
+static_assert(sizeof(PointStruct) == 2*sizeof(float) && is_trivially_copyable_v<PointStruct>,
+			  "Points are stored as pairs of floats");
+static_assert(sizeof(pair<unsigned int, unsigned int>) == 2*sizeof(uint32_t) && sizeof(unsigned int) == sizeof(uint32_t),
+			  "Segments are stored as pairs of uint32");
+
+static inline uint64_t alignOffset_(uint64_t offset){
+	return (offset + BinarySceneHeader::ALIGNMENT - 1) / BinarySceneHeader::ALIGNMENT * BinarySceneHeader::ALIGNMENT;
+}
+
+BinarySceneFile::BinarySceneFile(void)
+	:	file_(),
+		header_(),
+		points_(),
+		segments_()
+{
+}
+
+SceneFileStatus BinarySceneFile::open(const string& filePath, SceneFileError& error){
+	file_ = make_unique<MappedFile>(filePath);
+	points_ = {};
+	segments_ = {};
+	if (!file_->isOpen()){
+		return setError_(error, SceneFileStatus::FILE_NOT_FOUND, 0, "File not found: " + filePath);
+	}
+	const string_view contents = file_->getText();
+	const auto invalid = [&](const string& why){
+		return setError_(error, SceneFileStatus::INVALID_BINARY_FILE, 0, "Invalid binary scene file " + filePath + ": " + why);
+	};
+	if (contents.size() < sizeof(BinarySceneHeader)){
+		return invalid("too short");
+	}
+	memcpy(&header_, contents.data(), sizeof(BinarySceneHeader));
+	if (memcmp(header_.magic, BinarySceneHeader::MAGIC, sizeof(header_.magic)) != 0){
+		return invalid("not a binary scene file");
+	}
+	if (header_.version != BinarySceneHeader::VERSION || header_.headerSize < sizeof(BinarySceneHeader)){
+		return invalid("unsupported version " + to_string(header_.version));
+	}
+	const uint64_t size = contents.size();
+	if (header_.pointsOffset % BinarySceneHeader::ALIGNMENT != 0 || header_.pointsOffset > size ||
+		header_.numPoints > (size - header_.pointsOffset) / sizeof(PointStruct) ||
+		header_.segmentsOffset % BinarySceneHeader::ALIGNMENT != 0 || header_.segmentsOffset > size ||
+		header_.numSegments > (size - header_.segmentsOffset) / (2*sizeof(uint32_t))){
+		return invalid("the arrays don't fit in the file");
+	}
+	if (header_.numPoints > UINT_MAX || header_.numSegments > UINT_MAX){
+		return invalid("too many points or segments");
+	}
+	//	the mapping is page-aligned, so the arrays are aligned
+	points_ = span<const PointStruct>(reinterpret_cast<const PointStruct*>(contents.data() + header_.pointsOffset),
+									  header_.numPoints);
+	segments_ = span<const pair<unsigned int, unsigned int> >(
+					reinterpret_cast<const pair<unsigned int, unsigned int>*>(contents.data() + header_.segmentsOffset),
+					header_.numSegments);
+	for (size_t k=0; k<segments_.size(); k++){
+		if (segments_[k].first >= points_.size() || segments_[k].second >= points_.size()){
+			segments_ = {};
+			points_ = {};
+			return invalid("segment " + to_string(k) + " has an invalid point index");
+		}
+	}
+	return SceneFileStatus::OK;
+}
+
+void BinarySceneFile::copyTo(SceneFileData& data) const{
+	const size_t firstPoint = data.points.size();
+	data.xmin = header_.xmin;
+	data.xmax = header_.xmax;
+	data.ymin = header_.ymin;
+	data.ymax = header_.ymax;
+	data.points.insert(data.points.end(), points_.begin(), points_.end());
+	data.segments.reserve(data.segments.size() + segments_.size());
+	for (const auto& seg : segments_){
+		data.segments.emplace_back(static_cast<unsigned int>(firstPoint + seg.first),
+								   static_cast<unsigned int>(firstPoint + seg.second));
+	}
+}
+
+SceneFileStatus geometry::writeBinarySceneFile(const string& filePath, const SceneFileData& data, SceneFileError& error){
+	ofstream outFile(filePath, ios::binary | ios::trunc);
+	if (!outFile.is_open()){
+		return setError_(error, SceneFileStatus::WRITE_FAILED, 0, "Could not create file: " + filePath);
+	}
+	BinarySceneHeader header;
+	memcpy(header.magic, BinarySceneHeader::MAGIC, sizeof(header.magic));
+	header.version = BinarySceneHeader::VERSION;
+	header.headerSize = sizeof(BinarySceneHeader);
+	header.xmin = data.xmin;
+	header.xmax = data.xmax;
+	header.ymin = data.ymin;
+	header.ymax = data.ymax;
+	header.numPoints = data.points.size();
+	header.numSegments = data.segments.size();
+	header.pointsOffset = alignOffset_(sizeof(BinarySceneHeader));
+	header.segmentsOffset = alignOffset_(header.pointsOffset + header.numPoints * sizeof(PointStruct));
+
+	const char padding[BinarySceneHeader::ALIGNMENT] = {};
+	outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	outFile.write(padding, static_cast<streamsize>(header.pointsOffset - sizeof(header)));
+	outFile.write(reinterpret_cast<const char*>(data.points.data()),
+				  static_cast<streamsize>(header.numPoints * sizeof(PointStruct)));
+	outFile.write(padding, static_cast<streamsize>(header.segmentsOffset - header.pointsOffset -
+												   header.numPoints * sizeof(PointStruct)));
+	outFile.write(reinterpret_cast<const char*>(data.segments.data()),
+				  static_cast<streamsize>(header.numSegments * 2*sizeof(uint32_t)));
+	outFile.close();
+	if (outFile.fail()){
+		return setError_(error, SceneFileStatus::WRITE_FAILED, 0, "Could not write file: " + filePath);
+	}
+	return SceneFileStatus::OK;
+}
+
+bool geometry::isBinarySceneFile(const string& filePath){
+	ifstream inFile(filePath, ios::binary);
+	char magic[sizeof(BinarySceneHeader::MAGIC)];
+	return inFile.read(magic, sizeof(magic)) && memcmp(magic, BinarySceneHeader::MAGIC, sizeof(magic)) == 0;
+}
+
+SceneFileStatus geometry::convertSceneFile(const string& inFilePath, const string& outFilePath, SceneFileError& error){
+	SceneFileData data;
+	if (isBinarySceneFile(inFilePath)){
+		BinarySceneFile inFile;
+		if (inFile.open(inFilePath, error) != SceneFileStatus::OK){
+			return error.status;
+		}
+		inFile.copyTo(data);
+		return writeSceneFile(outFilePath, data, error);
+	}else{
+		if (readSceneFile(inFilePath, data, error) != SceneFileStatus::OK){
+			return error.status;
+		}
+		return writeBinarySceneFile(outFilePath, data, error);
+	}
+}
+
+#if 0
+//-----------------------------------------------------------------
+#pragma mark -
+#pragma mark Scene loading
+//-----------------------------------------------------------------
+#endif
+
+void geometry::copyFromScene(const Scene& scene, SceneFileData& data){
+	const size_t firstPoint = data.points.size();
+	data.points.reserve(firstPoint + scene.getAllPoints().size());
+	for (const auto& pt : scene.getAllPoints()){
+		data.points.emplace_back(pt->getX(), pt->getY());
+	}
+	data.segments.reserve(data.segments.size() + scene.getAllSegments().size());
+	for (const auto& seg : scene.getAllSegments()){
+		data.segments.emplace_back(static_cast<unsigned int>(firstPoint + seg->getP1Id().idx),
+								   static_cast<unsigned int>(firstPoint + seg->getP2Id().idx));
+	}
+}
+
+void geometry::addToScene(const SceneFileData& data, Scene& scene){
+	vector<PointId> ids;
+	scene.makeNewPointIds(data.points, ids);
+	scene.makeNewSegIds(data.segments, ids);
+}
+
+void geometry::addToScene(const BinarySceneFile& file, Scene& scene){
+	vector<PointId> ids;
+	scene.makeNewPointIds(file.getPoints(), ids);
+	scene.makeNewSegIds(file.getSegments(), ids);
+}
@@ -0,0 +1,334 @@
+//
+//  SceneGenerator.cpp
+//
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#include "SceneGenerator.hpp"
+#include "Segment.hpp"
+#include "SegmentSoA.hpp"
+
+using namespace std;
+using namespace geometry;
+
+/**	Maximum number of scenes generated in the search of the scale of a target */
+#define MAX_TRIALS	64
+
+/**	Largest scale tried for a target: beyond it the segments are so much longer than the
+ *	world that the crossings don't grow anymore
+ */
+#define MAX_SCALE	1024.0
+
+/**	Number of bits of the coordinates of the DEGENERATE scenes, which are multiples of a
+ *	power of 2 so that floats hold them exactly (with room for the groups that stick out
+ *	of the world)
+ */
+#define LATTICE_BITS	22
+
+/**	Number of segments of a group of the DEGENERATE distribution */
+#define GROUP_SIZE	4
+
+static const char* const DISTRIBUTION_NAMES[] = {"uniform", "short", "long", "grid", "degenerate"};
+
+#if 0
+//----------------------------------------------------------------------------------
+#pragma mark -
+#pragma mark Distributions
+//----------------------------------------------------------------------------------
+#endif
+
+/**	Uniform double in [0, 1).  Computed from the bits of the generator rather than with
+ *	uniform_real_distribution, whose results depend on the standard library.
+ */
+static inline double uniform_(mt19937_64& rng){
+	return static_cast<double>(rng() >> 11) * 0x1.0p-53;
+}
+
+static void addSegment_(SceneFileData& data, double x1, double y1, double x2, double y2){
+	const unsigned int first = static_cast<unsigned int>(data.points.size());
+	data.points.emplace_back(static_cast<float>(x1), static_cast<float>(y1));
+	data.points.emplace_back(static_cast<float>(x2), static_cast<float>(y2));
+	data.segments.emplace_back(first, first + 1);
+}
+
+/**	Adds the segment of center (cx, cy) and of half-extent (hx, hy) at scale 1
+ */
+static inline void addScaledSegment_(SceneFileData& data, double scale, double cx, double cy, double hx, double hy){
+	addSegment_(data, cx - scale*hx, cy - scale*hy, cx + scale*hx, cy + scale*hy);
+}
+
+static void generateUniform_(mt19937_64& rng, size_t n, double size, double scale, SceneFileData& data){
+	for (size_t k=0; k<n; k++){
+		const double x1 = size * uniform_(rng), y1 = size * uniform_(rng);
+		const double x2 = size * uniform_(rng), y2 = size * uniform_(rng);
+		addScaledSegment_(data, scale, 0.5*(x1 + x2), 0.5*(y1 + y2), 0.5*(x2 - x1), 0.5*(y2 - y1));
+	}
+}
+
+/**	The segments are between half and 1.5 times the distance between neighboring centers
+ */
+static void generateShort_(mt19937_64& rng, size_t n, double size, double scale, SceneFileData& data){
+	const double spacing = size / sqrt(static_cast<double>(n));
+	for (size_t k=0; k<n; k++){
+		const double cx = size * uniform_(rng), cy = size * uniform_(rng);
+		const double angle = M_PI * uniform_(rng);
+		const double halfLength = 0.5 * spacing * (0.5 + uniform_(rng));
+		addScaledSegment_(data, scale, cx, cy, halfLength * cos(angle), halfLength * sin(angle));
+	}
+}
+
+/**	Point of parameter t in [0, 1) on a side of the world (bottom, right, top, left)
+ */
+static void sidePoint_(unsigned int side, double t, double size, double& x, double& y){
+	switch (side){
+		case 0:		x = t * size;	y = 0.0;		break;
+		case 1:		x = size;		y = t * size;	break;
+		case 2:		x = t * size;	y = size;		break;
+		default:	x = 0.0;		y = t * size;	break;
+	}
+}
+
+static void generateLong_(mt19937_64& rng, size_t n, double size, double scale, SceneFileData& data){
+	for (size_t k=0; k<n; k++){
+		const unsigned int side1 = static_cast<unsigned int>(rng() % 4);
+		const unsigned int side2 = (side1 + 1 + static_cast<unsigned int>(rng() % 3)) % 4;
+		double x1, y1, x2, y2;
+		sidePoint_(side1, uniform_(rng), size, x1, y1);
+		sidePoint_(side2, uniform_(rng), size, x2, y2);
+		addScaledSegment_(data, scale, 0.5*(x1 + x2), 0.5*(y1 + y2), 0.5*(x2 - x1), 0.5*(y2 - y1));
+	}
+}
+
+/**	Horizontal and vertical segments alternate.  At scale 1 they are as long as the world
+ *	and centered anywhere on their line.
+ */
+static void generateGrid_(mt19937_64& rng, size_t n, double size, double scale, SceneFileData& data){
+	const size_t numHorizontal = (n + 1) / 2, numVertical = max(n / 2, size_t(1));
+	for (size_t k=0; k<n; k++){
+		const double center = size * uniform_(rng);
+		if (k % 2 == 0){
+			const double y = size * (static_cast<double>(k / 2) + 0.5) / static_cast<double>(numHorizontal);
+			addScaledSegment_(data, scale, center, y, 0.5*size, 0.0);
+		}else{
+			const double x = size * (static_cast<double>(k / 2) + 0.5) / static_cast<double>(numVertical);
+			addScaledSegment_(data, scale, x, center, 0.0, 0.5*size);
+		}
+	}
+}
+
+/**	Groups of GROUP_SIZE segments along a direction d of small integer coordinates and its
+ *	normal e, whose points are the center of the group plus integer multiples of d and e
+ *	times a step, so that all the coordinates are multiples of the lattice unit:
+ *		- a chain of collinear segments, each sharing an endpoint with the next one
+ *		- collinear segments that overlap
+ *		- a star of segments sharing an endpoint, two by two on a common line
+ *		- a segment with another one ending on its interior, another one crossing it at a
+ *		  point of the lattice, and another one sharing its endpoint
+ *	The scale sets the step, in whole lattice units.
+ */
+static void generateDegenerate_(mt19937_64& rng, size_t n, double size, double scale, SceneFileData& data){
+	static const int DIRECTIONS[][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}, {2, 1}, {1, 2}, {2, -1}, {1, -2}};
+	//	Chains and overlaps are indices in the points c + k step d, for k from 0 to 4
+	static const unsigned int CHAIN[GROUP_SIZE][2] = {{0, 1}, {1, 2}, {2, 3}, {3, 4}};
+	static const unsigned int OVERLAP[GROUP_SIZE][2] = {{0, 2}, {1, 3}, {2, 4}, {0, 4}};
+	//	Stars and junctions are offsets from the center, in steps along d and e
+	static const int STAR[GROUP_SIZE][4] = {{0, 0, 2, 0}, {0, 0, 0, 2}, {0, 0, -2, 0}, {0, 0, 0, -2}};
+	static const int JUNCTION[GROUP_SIZE][4] = {{-2, 0, 2, 0}, {0, 0, 0, 2}, {1, -1, 1, 1}, {2, 0, 2, 2}};
+
+	const double unit = ldexp(1.0, ilogb(size) + 1 - LATTICE_BITS);
+	const double numGroups = ceil(static_cast<double>(n) / GROUP_SIZE);
+	//	The groups span about 4 steps, the distance between their centers at scale 1
+	const double maxSteps = floor(0.25 * size / unit);
+	const double steps = min(max(round(scale * size / (4.0 * sqrt(numGroups) * unit)), 1.0), maxSteps);
+	const double step = steps * unit;
+
+	for (size_t first=0; first<n; first+=GROUP_SIZE){
+		const double cx = round(size * uniform_(rng) / unit) * unit;
+		const double cy = round(size * uniform_(rng) / unit) * unit;
+		const int* d = DIRECTIONS[rng() % (sizeof(DIRECTIONS) / sizeof(DIRECTIONS[0]))];
+		const double dx = d[0] * step, dy = d[1] * step, ex = -d[1] * step, ey = d[0] * step;
+		const size_t count = min(n - first, size_t(GROUP_SIZE));
+
+		switch ((first / GROUP_SIZE) % 4){
+			case 0:
+			case 1:{
+				//	the points are shared by the segments, as in a scene file that was saved
+				const unsigned int base = static_cast<unsigned int>(data.points.size());
+				for (int k=0; k<=GROUP_SIZE; k++){
+					data.points.emplace_back(static_cast<float>(cx + k*dx), static_cast<float>(cy + k*dy));
+				}
+				const unsigned int (*ends)[2] = (first / GROUP_SIZE) % 4 == 0 ? CHAIN : OVERLAP;
+				for (size_t k=0; k<count; k++){
+					data.segments.emplace_back(base + ends[k][0], base + ends[k][1]);
+				}
+				break;
+			}
+			default:{
+				const int (*offsets)[4] = (first / GROUP_SIZE) % 4 == 2 ? STAR : JUNCTION;
+				for (size_t k=0; k<count; k++){
+					const int* o = offsets[k];
+					addSegment_(data, cx + o[0]*dx + o[1]*ex, cy + o[0]*dy + o[1]*ey,
+								cx + o[2]*dx + o[3]*ex, cy + o[2]*dy + o[3]*ey);
+				}
+				break;
+			}
+		}
+	}
+}
+
+/**	Generates the scene of the settings at a scale.  The random numbers drawn don't depend on
+ *	the scale, so that the scenes of different scales have the same centers.
+ */
+static void generateAtScale_(const SceneGeneratorSettings& settings, double scale, SceneFileData& data){
+	mt19937_64 rng(settings.seed);
+	const size_t n = settings.numSegments;
+	const double size = settings.worldSize;
+	data = SceneFileData();
+	data.points.reserve(2*n);
+	data.segments.reserve(n);
+	switch (settings.distribution){
+		case SceneDistribution::UNIFORM:
+			generateUniform_(rng, n, size, scale, data);
+			break;
+		case SceneDistribution::SHORT:
+			generateShort_(rng, n, size, scale, data);
+			break;
+		case SceneDistribution::LONG:
+			generateLong_(rng, n, size, scale, data);
+			break;
+		case SceneDistribution::GRID:
+			generateGrid_(rng, n, size, scale, data);
+			break;
+		case SceneDistribution::DEGENERATE:
+			generateDegenerate_(rng, n, size, scale, data);
+			break;
+	}
+
+	//	The world is the square of the settings, grown to the segments that stick out
+	data.xmin = data.ymin = 0.f;
+	data.xmax = data.ymax = settings.worldSize;
+	for (const PointStruct& pt : data.points){
+		data.xmin = min(data.xmin, pt.x);
+		data.xmax = max(data.xmax, pt.x);
+		data.ymin = min(data.ymin, pt.y);
+		data.ymax = max(data.ymax, pt.y);
+	}
+}
+
+/**	First scale tried for a target.  Segments of total length L, of random directions in a
+ *	world of area A, cross about L^2 / (pi A) times (Buffon).
+ */
+static double initialScale_(const SceneGeneratorSettings& settings, const SceneFileData& natural){
+	if (settings.targetCrossings == 0){
+		return 1.0;
+	}
+	double totalLength = 0.0;
+	for (const pair<unsigned int, unsigned int>& seg : natural.segments){
+		const PointStruct& pt1 = natural.points[seg.first];
+		const PointStruct& pt2 = natural.points[seg.second];
+		totalLength += hypot(static_cast<double>(pt2.x) - pt1.x, static_cast<double>(pt2.y) - pt1.y);
+	}
+	const double area = static_cast<double>(settings.worldSize) * settings.worldSize;
+	const double scale = sqrt(static_cast<double>(settings.targetCrossings) * M_PI * area) / max(totalLength, 1E-30);
+	return min(max(scale, 1E-6), MAX_SCALE);
+}
+
+#if 0
+//----------------------------------------------------------------------------------
+#pragma mark -
+#pragma mark Public functions
+//----------------------------------------------------------------------------------
+#endif
+
+void geometry::generateScene(const SceneGeneratorSettings& settings, SceneFileData& data, SceneGeneratorStats* stats){
+	SceneGeneratorStats result;
+	generateAtScale_(settings, 1.0, data);
+	result.numTrials = 1;
+	if (settings.targetCrossings == SceneGeneratorSettings::NO_TARGET){
+		if (settings.countCrossings){
+			result.numCrossings = countCrossings(data);
+			result.crossingsCounted = true;
+		}
+		if (stats != nullptr){
+			*stats = result;
+		}
+		return;
+	}
+
+	//	Bisection of the scale, after doubling or halving it until the target is bracketed
+	const double target = static_cast<double>(settings.targetCrossings);
+	double scale = initialScale_(settings, data);
+	double lower = 0.0, upper = numeric_limits<double>::infinity();
+	double bestScale = scale, bestError = numeric_limits<double>::infinity();
+	size_t bestCrossings = 0;
+	for (unsigned int trial=0; trial<MAX_TRIALS; trial++){
+		if (scale != 1.0 || trial != 0){
+			generateAtScale_(settings, scale, data);
+			result.numTrials++;
+		}
+		const size_t crossings = countCrossings(data);
+		const double error = fabs(static_cast<double>(crossings) - target);
+		if (error < bestError){
+			bestScale = scale;
+			bestError = error;
+			bestCrossings = crossings;
+		}
+		if (error <= settings.tolerance * target){
+			break;
+		}
+		if (static_cast<double>(crossings) < target){
+			lower = scale;
+		}else{
+			upper = scale;
+		}
+		const double next = isinf(upper) ? 2.0 * scale : 0.5 * (lower + upper);
+		if (next > MAX_SCALE || (!isinf(upper) && upper - lower <= 1E-9 * upper)){
+			break;
+		}
+		scale = next;
+	}
+	if (bestScale != scale){
+		generateAtScale_(settings, bestScale, data);
+		result.numTrials++;
+	}
+	result.scale = bestScale;
+	result.numCrossings = bestCrossings;
+	result.crossingsCounted = true;
+	if (stats != nullptr){
+		*stats = result;
+	}
+}
+
+size_t geometry::countCrossings(const SceneFileData& data){
+	vector<SegmentCoords> coords;
+	coords.reserve(data.segments.size());
+	for (const pair<unsigned int, unsigned int>& seg : data.segments){
+		const PointStruct& pt1 = data.points[seg.first];
+		const PointStruct& pt2 = data.points[seg.second];
+		coords.push_back({pt1.x, pt1.y, pt2.x, pt2.y, static_cast<unsigned int>(coords.size())});
+	}
+	const SegmentSoA soa(coords);
+	size_t count = 0;
+	forEachIntersectionGrid(soa, [&count](const IntersectionRecord& ){
+		count++;
+	});
+	return count;
+}
+
+const char* geometry::getDistributionName(SceneDistribution distribution){
+	return DISTRIBUTION_NAMES[static_cast<int>(distribution)];
+}
+
+bool geometry::parseDistributionName(const string& name, SceneDistribution& distribution){
+	for (size_t k=0; k<sizeof(DISTRIBUTION_NAMES) / sizeof(DISTRIBUTION_NAMES[0]); k++){
+		if (name == DISTRIBUTION_NAMES[k]){
+			distribution = static_cast<SceneDistribution>(k);
+			return true;
+		}
+	}
+	return false;
+}
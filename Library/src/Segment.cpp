@@ -9,45 +9,49 @@
 #include <algorithm>
 #include <set>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <memory>
+#include <cmath>
 #include <utility>
+#include <thread>
+#include <atomic>
+#include <iterator>
+#include <bit>
+#include <span>
+#include <climits>
 
+#include "Geometry.hpp"
 #include "Point.hpp"
 #include "Segment.hpp"
+#include "Scene.hpp"
+#include "OrientationKernel.hpp"
+#include "Predicates.hpp"
+#include "Counters.hpp"
+#include "SegmentGrid.hpp"
+#include "SegmentSoA.hpp"
 
 
 using namespace std;
 using namespace geometry;
 
-/**
- *Static variables redeclared in source code
- */
-set<shared_ptr<Segment> > Segment::segSet_;
-vector<shared_ptr<Segment> > Segment::segVect_;
-unsigned int Segment::count_ = 0;
-
-
-const GLfloat SEGMENT_COLOR[][4] = {
-									{1.f, 1.f, 1.f, 1.f},	//	SEGMENT,
-									{0.7f, 1.f, 0.7f, 1.f},	//	CREATED_SEGMENT,
-									{0.f, 0.f, 1.f, 1.f}	//	EDITED_SEGMENT
-};
 /**Constructor function that can only be called using the class itself and not by user
+ * @param idx the index of the segment in the scene of its endpoints
  * @param pt1 a reference to a point 1 which will be used to create a segment
  * @param pt2 a reference to a point 2 which will be used to create a segment
  * @param token - the object of segmentToken class (which acts like passkey attribute) so that it is not accessible by anyone else
  */
-Segment::Segment(SegmentToken token, shared_ptr<Point> pt1, shared_ptr<Point> pt2)
+Segment::Segment(SegmentToken token, unsigned int idx, shared_ptr<Point> pt1, shared_ptr<Point> pt2)
     :
 		p1_((pt1->y_ < pt2->y_) || ((pt1->y_ < pt2->y_) && (pt1->x_ < pt2->x_)) ? pt1 :  pt2),
 		p2_((pt1->y_ < pt2->y_) || ((pt1->y_ < pt2->y_) && (pt1->x_ < pt2->x_)) ? pt2 :  pt1),
-        idx_(count_++)
+        idx_(idx)
 {
 	(void) token;
 	
 	/**	add myself to segList of p1 and p2*/
-	p1_->segList_.insert(idx_);
-	p2_->segList_.insert(idx_);
+	p1_->segList_.push_back(idx_);
+	p2_->segList_.push_back(idx_);
 }
 Segment::Segment(shared_ptr<Point>  pt1, shared_ptr<Point>  pt2)
     :
@@ -71,38 +75,19 @@ Segment::~Segment(void){
 //-----------------------------------------------------------------
 #endif
 
-shared_ptr<Segment> Segment::makeNewSegPtr(shared_ptr<Point> pt1, shared_ptr<Point> pt2){
-    bool found = false;
-    shared_ptr<Segment> p;
-    for(auto iter = segSet_.begin(); iter!=segSet_.end();iter++){
-        /** segSet is a set of pointers to segments
-         *  so we need to dereference the segment pointer  to check the point pairs
-         */
-        if( ((*iter)->p1_->idx_ == pt1->idx_ && (*iter)->p2_->idx_ == pt2->idx_) ||
-			((*iter)->p2_->idx_ == pt1->idx_ && (*iter)->p1_->idx_ == pt2->idx_)){
-            found = true;
-            /**return pointer to the segment*/
-            p = *iter;
-            break;
-        }
-    }
-    if (found){
-        return p;
-    }else{
-        shared_ptr<Segment> currSeg = make_shared<Segment>(SegmentToken{}, pt1, pt2);
-        segSet_.insert(currSeg);
-        segVect_.push_back(currSeg);
-		pt1->segList_.insert(currSeg->idx_);
-		pt2->segList_.insert(currSeg->idx_);
-        return currSeg;
-    }
+shared_ptr<Segment> Segment::makeNewSegPtr(const shared_ptr<Point>& pt1, const shared_ptr<Point>& pt2){
+    return Scene::getDefault().makeNewSegPtr(pt1, pt2);
+}
+
+Segment& Segment::makeNewSeg(const shared_ptr<Point>& pt1, const shared_ptr<Point>& pt2){
+   return Scene::getDefault().makeNewSeg(pt1, pt2);
 }
 
-Segment& Segment::makeNewSeg(shared_ptr<Point> pt1, shared_ptr<Point> pt2){
-   return *(makeNewSegPtr(pt1, pt2));
+SegmentId Segment::makeNewSegId(PointId pt1, PointId pt2){
+    return Scene::getDefault().makeNewSegId(pt1, pt2);
 }
 
-Segment Segment::makeNewTempSeg(shared_ptr<Point> pt1, shared_ptr<Point> pt2){
+Segment Segment::makeNewTempSeg(const shared_ptr<Point>& pt1, const shared_ptr<Point>& pt2){
     return Segment(pt1, pt2);
 }
 
@@ -110,56 +95,45 @@ Segment Segment::makeNewTempSeg(shared_ptr<Point> pt1, shared_ptr<Point> pt2){
 #if 0
 //-----------------------------------------------------------------
 #pragma mark -
-#pragma mark Rendering functions
+#pragma mark Default scene
 //-----------------------------------------------------------------
 #endif
 
-void Segment::render(SegmentType type) const{
-	/**	first draw the segment, then draw its endpoints*/
-	render_(*p1_, *p2_, type);
-	p1_->render(PointType::ENDPOINT);
-	p2_->render(PointType::ENDPOINT);
-}
-
-void Segment::render_(const Point& pt1, const Point& pt2, SegmentType type){
-	switch (type){
-		using enum SegmentType;
-		
-		case SEGMENT:
-			glColor4fv(SEGMENT_COLOR[0]);
-			break;
-
-		case EDITED_SEGMENT:
-			glColor4fv(SEGMENT_COLOR[2]);
-			break;
-		
-		default:
-			break;
-	}
-	
-	glBegin(GL_LINES);
-		glVertex2f(pt1.getX(), pt1.getY());
-		glVertex2f(pt2.getX(), pt2.getY());
-	glEnd();
+const Segment& Segment::getSegment(SegmentId id){
+	return Scene::getDefault().getSegment(id);
 }
 
-void Segment::renderCreated(const PointStruct& pt1, const PointStruct& pt2){
-	glColor4fv(SEGMENT_COLOR[1]);
-	
-	glBegin(GL_LINES);
-		glVertex2f(pt1.x, pt1.y);
-		glVertex2f(pt2.x, pt2.y);
-	glEnd();
+const shared_ptr<Segment>& Segment::getSegmentPtr(SegmentId id){
+	return Scene::getDefault().getSegmentPtr(id);
+}
 
-	Point::render(pt1, PointType::FIRST_ENDPOINT);
+const vector<shared_ptr<Segment> >& Segment::getAllSegments(void){
+	return Scene::getDefault().getAllSegments();
 }
 
-void Segment::renderAllSegments(void){
-	for (auto seg : segSet_) {
-		seg->render(SegmentType::SEGMENT);
-	}
+void Segment::clearAllSegments(void){
+	Scene::getDefault().clearAllSegments();
+}
+
+unsigned long long Segment::getVersion(void){
+	return Scene::getDefault().getSegmentVersion();
+}
+
+void Segment::setIncrementalIntersections(bool on){
+	Scene::getDefault().setIncrementalIntersections(on);
 }
 
+bool Segment::getIncrementalIntersections(void){
+	return Scene::getDefault().getIncrementalIntersections();
+}
+
+const vector<IntersectionRecord>& Segment::getLiveIntersections(void){
+	return Scene::getDefault().getLiveIntersections();
+}
+
+void Segment::setIndexCellSize(float size){
+	Scene::getDefault().setIndexCellSize(size);
+}
 
 #if 0
 //-----------------------------------------------------------------
@@ -172,85 +146,365 @@ void Segment::renderAllSegments(void){
  *@param pt - a reference to a constant point which has to be checked on its direction to the segment
  *@return boolean that tells if the point is on left or not
  */
-bool Segment::isOnLeftSide(const shared_ptr<Point> pt) const{
+bool Segment::isOnLeftSide(const shared_ptr<Point>& pt) const{
     /**The determinant of a pt to the segment is:
      *  det( p2 - p1, pt - p1)
+     * Its sign is computed exactly (see Predicates.hpp), so that nearly collinear points
+     * get consistent answers.
      */
-    float det  = ((pt->x_ - p1_->x_) * (p2_->y_ - p1_->y_)) - ((p2_->x_ - p1_->x_) * (pt->y_ - p1_->y_ ));
-    if(det > 0){
-        return true;
-    }else{
-        return false;
-    }
+    return orientation(p1_->x_, p1_->y_, p2_->x_, p2_->y_, pt->x_, pt->y_) > 0;
 //
 //    PointStruct pts = {pt.getX(), pt.getY()};
 //    return isOnLeftSide(pts);
 }
 
 bool Segment::isOnLeftSide(const PointStruct& pt) const{
-    float det  = ((pt.x - p1_->x_) * (p2_->y_ - p1_->y_)) - ((p2_->x_ - p1_->x_) * (pt.y - p1_->y_ ));
-    if(det > 0){
-        return true;
-    }else{
-        return false;
-    }
+    return orientation(p1_->x_, p1_->y_, p2_->x_, p2_->y_, pt.x, pt.y) > 0;
+}
+bool Segment::isOnLeftSide(PointId pt) const{
+	return isOnLeftSide(getScene().getCoordinates(pt));
 }
-bool Segment::areOnOppositeSides(const shared_ptr<Point> pt1, const shared_ptr<Point> pt2) const{
-	bool pt1IsLeft = isOnLeftSide(pt1);
-	bool pt2IsLeft = isOnLeftSide(pt2);
-	return ((pt1IsLeft && !pt2IsLeft) || (!pt1IsLeft && pt2IsLeft));
+bool Segment::areOnOppositeSides(const shared_ptr<Point>& pt1, const shared_ptr<Point>& pt2) const{
+	return areOnOppositeSides(PointStruct{pt1->x_, pt1->y_}, PointStruct{pt2->x_, pt2->y_});
 }
 bool Segment::areOnOppositeSides(const PointStruct& pt1, const PointStruct& pt2) const{
-    bool pt1IsLeft = isOnLeftSide(pt1);
-	bool pt2IsLeft = isOnLeftSide(pt2);
-	return ((pt1IsLeft && !pt2IsLeft) || (!pt1IsLeft && pt2IsLeft));
+	//	strictly: a point on the segment's line is on neither side
+	const int side1 = orientation(p1_->x_, p1_->y_, p2_->x_, p2_->y_, pt1.x, pt1.y);
+	const int side2 = orientation(p1_->x_, p1_->y_, p2_->x_, p2_->y_, pt2.x, pt2.y);
+	return side1 * side2 < 0;
 }
 bool Segment::intersects(const Segment& seg) const{
+    GEOMETRY_COUNT(SEGMENT_PAIR_TESTS);
     return areOnOppositeSides(seg.p1_, seg.p2_) && seg.areOnOppositeSides(p1_, p2_);;
 }
-bool Segment::intersects(const shared_ptr<Point> pt1, const shared_ptr<Point> pt2) const{
+bool Segment::intersects(SegmentId seg) const{
+	return intersects(getScene().getSegment(seg));
+}
+bool Segment::intersects(const shared_ptr<Point>& pt1, const shared_ptr<Point>& pt2) const{
+		GEOMETRY_COUNT(SEGMENT_PAIR_TESTS);
 		Segment seg(pt1, pt2);
         return areOnOppositeSides(pt1, pt2) && seg.areOnOppositeSides(p1_, p2_);
 }
 bool Segment::intersects(const PointStruct& pt1, const PointStruct& pt2) const{
+		GEOMETRY_COUNT(SEGMENT_PAIR_TESTS);
 		SegmentStruct segStruct(pt1, pt2);
 		PointStruct ps1{p1_->x_, p1_->y_};
 		PointStruct ps2{p2_->x_, p2_->y_};
         return areOnOppositeSides(pt1, pt2) && segStruct.areOnOppositeSides(ps1, ps2);
 }
-unique_ptr<PointStruct> Segment::findIntersection(const Segment& interSeg){
+/**	Intersection point of the lines through segment A = (ax1, ay1)-(ax2, ay2) and
+ *	segment B = (bx1, by1)-(bx2, by2), computed as a point of A.
+ *	Kept out of line so that all the search functions get bit-identical points: once
+ *	inlined, the compiler may contract the expressions into FMAs differently at each call site.
+ */
+#if defined(__GNUC__)
+	__attribute__((noinline))
+#endif
+static void intersectionPoint_(float ax1, float ay1, float ax2, float ay2,
+									  float bx1, float by1, float bx2, float by2, PointStruct& interPt){
+	GEOMETRY_COUNT(INTERSECTION_POINTS);
+	const float interSegDX = bx2 - bx1;
+	const float currSegDX = ax2 - ax1;
+	const float interSegDY = by2 - by1;
+	const float currSegDY = ay2 - ay1;
+
+	float denom = interSegDX*currSegDY - interSegDY*currSegDX;
+	float num = interSegDY*(ax1 - bx1) - interSegDX*(ay1 - by1);
+	float alpha = num/denom;
+	interPt.x = ax1 + alpha*currSegDX;
+	interPt.y = ay1 + alpha*currSegDY;
+}
+
+bool Segment::findIntersection(const Segment& interSeg, PointStruct& interPt) const{
     if(intersects(interSeg)){
-		const float interSegDX = interSeg.p2_->x_ - interSeg.p1_->x_;
-		const float currSegDX = p2_->x_ - p1_->x_;
-		const float interSegDY = interSeg.p2_->y_ - interSeg.p1_->y_;
-		const float currSegDY = p2_->y_ - p1_->y_;
-
-		float denom = interSegDX*currSegDY - interSegDY*currSegDX;
-		float num = interSegDY*(p1_->x_ - interSeg.p1_->x_) -
-					interSegDX*(p1_->y_ - interSeg.p1_->y_);
-		float alpha = num/denom;
-		float interX = p1_->x_ + alpha*currSegDX;
-		float interY = p1_->y_ + alpha*currSegDY;
-        return make_unique<PointStruct>(interX, interY);
+		intersectionPoint_(p1_->x_, p1_->y_, p2_->x_, p2_->y_,
+						   interSeg.p1_->x_, interSeg.p1_->y_, interSeg.p2_->x_, interSeg.p2_->y_, interPt);
+		return true;
+    }else{
+        return false;
+    }
+}
+
+bool Segment::findIntersection(SegmentId interSeg, PointStruct& interPt) const{
+	return findIntersection(getScene().getSegment(interSeg), interPt);
+}
 
+unique_ptr<PointStruct> Segment::findIntersection(const Segment& interSeg){
+	PointStruct interPt;
+    if(findIntersection(interSeg, interPt)){
+        return make_unique<PointStruct>(interPt);
     }else{
         //	if no intersection found return a null pointer
         return nullptr;
     }
 }
+
+/**	Record of the intersection of segments i and j of a snapshot, whose orientation tests said
+ *	that they intersect.  segA and segB are set to the positions i and j in the snapshot.
+ */
+static inline IntersectionRecord makeRecord_(const SegmentSoA& coords, size_t i, size_t j){
+	PointStruct interPt;
+	intersectionPoint_(coords.x1()[i], coords.y1()[i], coords.x2()[i], coords.y2()[i],
+					   coords.x1()[j], coords.y1()[j], coords.x2()[j], coords.y2()[j], interPt);
+	return IntersectionRecord{interPt.x, interPt.y, static_cast<unsigned int>(i), static_cast<unsigned int>(j)};
+}
+
+/**	Replaces the positions (in the snapshot) of the segments of records [first, end) of out
+ *	by the segments' indices
+ */
+static void positionsToIndices_(const SegmentSoA& coords, vector<IntersectionRecord>& out, size_t first){
+	for (size_t k=first; k<out.size(); k++){
+		out[k].segA = coords.getIndex(out[k].segA);
+		out[k].segB = coords.getIndex(out[k].segB);
+	}
+}
+
+/**	Prepares an output buffer: cleared unless we append to it, then room made for reserveHint more records */
+static inline void prepareOutput_(vector<IntersectionRecord>& out, size_t reserveHint, bool append){
+	if (!append){
+		out.clear();
+	}
+	if (reserveHint > 0){
+		out.reserve(out.size() + reserveHint);
+	}
+}
+
+/**	Converts records to the PointStruct form returned by the older search functions */
+static vector<unique_ptr<PointStruct> > toPointStructs_(const vector<IntersectionRecord>& records){
+	vector<unique_ptr<PointStruct> > intersectVect;
+	intersectVect.reserve(records.size());
+	for (const IntersectionRecord& rec : records){
+		intersectVect.push_back(make_unique<PointStruct>(rec.x, rec.y));
+	}
+	return intersectVect;
+}
+
+/**	Tests segment i of vect against segments [jStart, jEnd) of vect, one batch at a time,
+ *	and calls found(j) for each segment j that intersects it, in increasing order of j.
+ */
+template <typename Callback>
+static inline void testAgainstRange_(const SegmentSoA& coords, size_t i, size_t jStart, size_t jEnd,
+									 Callback&& found){
+	const float ax1 = coords.x1()[i], ay1 = coords.y1()[i];
+	const float ax2 = coords.x2()[i], ay2 = coords.y2()[i];
+	for (size_t j0=jStart; j0<jEnd; j0+=ORIENTATION_BATCH_SIZE){
+		uint32_t mask = intersectsBatch(ax1, ay1, ax2, ay2,
+										coords.x1()+j0, coords.y1()+j0, coords.x2()+j0, coords.y2()+j0,
+										std::min(jEnd - j0, ORIENTATION_BATCH_SIZE));
+		while (mask != 0){
+			found(j0 + static_cast<size_t>(std::countr_zero(mask)));
+			mask &= mask - 1;
+		}
+	}
+}
+
+/**	Calls found(i, j) for each pair of segments i < j of a snapshot that intersect, by
+ *	increasing i then j
+ */
+template <typename Callback>
+static void forEachIntersectionBruteForce_(const SegmentSoA& coords, Callback&& found){
+	for (size_t i=0; i<coords.size(); i++){
+		testAgainstRange_(coords, i, i+1, coords.size(), [&](size_t j){
+			found(i, j);
+		});
+	}
+}
+
+void geometry::findAllIntersectionsBruteForce(const vector<shared_ptr<Segment> >& vect, vector<IntersectionRecord>& out,
+											  size_t reserveHint, bool append){
+	prepareOutput_(out, reserveHint, append);
+	const size_t first = out.size();
+	const shared_ptr<const SegmentSoA> soa = SegmentSoA::getSnapshot(vect);
+	const SegmentSoA& coords = *soa;
+	forEachIntersectionBruteForce_(coords, [&](size_t i, size_t j){
+		out.push_back(makeRecord_(coords, i, j));
+	});
+	positionsToIndices_(coords, out, first);
+}
+
 vector<unique_ptr<PointStruct> > geometry::findAllIntersectionsBruteForce(const vector<shared_ptr<Segment> >& vect){
+	vector<IntersectionRecord> records;
+	findAllIntersectionsBruteForce(vect, records);
+	return toPointStructs_(records);
+}
+
+/**	Side of the square tiles of segment pairs handed out to the threads */
+#define PAIR_TILE_SIZE	256
+
+void geometry::findAllIntersectionsBruteForceParallel(const vector<shared_ptr<Segment> >& vect, vector<IntersectionRecord>& out,
+													  unsigned int numThreads, bool deterministic,
+													  size_t reserveHint, bool append){
+	prepareOutput_(out, reserveHint, append);
+	const size_t n = vect.size();
+	if (numThreads == 0){
+		numThreads = std::max(1U, thread::hardware_concurrency());
+	}
 	
-	vector<unique_ptr<PointStruct> > intersectVect;
-	for (size_t i=0; i<vect.size(); i++){
-		for (size_t j=i+1; j<vect.size(); j++){
-			unique_ptr<PointStruct> pt = vect[i]->findIntersection(*(vect[j]));
-			if (pt != nullptr){
-				intersectVect.push_back(std::move(pt));
+	/**	Tile (bi, bj), bi <= bj, covers the pairs (i, j>i) with i in block bi and j in block bj.
+	 *	Diagonal tiles hold half as many pairs, but there are few of them, and since the threads
+	 *	pick up tiles one at a time until there are none left, the load stays balanced.
+	 */
+	const size_t numBlocks = (n + PAIR_TILE_SIZE - 1) / PAIR_TILE_SIZE;
+	vector<pair<unsigned int, unsigned int> > tiles;
+	tiles.reserve(numBlocks*(numBlocks+1)/2);
+	for (size_t bi=0; bi<numBlocks; bi++){
+		for (size_t bj=bi; bj<numBlocks; bj++){
+			tiles.emplace_back(static_cast<unsigned int>(bi), static_cast<unsigned int>(bj));
+		}
+	}
+	numThreads = static_cast<unsigned int>(std::min<size_t>(numThreads, std::max<size_t>(tiles.size(), 1)));
+
+	/**	Each thread collects its intersections in its own buffer, with the positions of the pair
+	 *	in vect (rather than the segment indices) to restore the serial order.  The first thread
+	 *	writes directly at the end of the output buffer.
+	 */
+	const shared_ptr<const SegmentSoA> soa = SegmentSoA::getSnapshot(vect);
+	const SegmentSoA& coords = *soa;
+	const size_t first = out.size();
+	vector<vector<IntersectionRecord> > threadResults(numThreads);
+	atomic<size_t> nextTile{0};
+	
+	auto worker = [&](unsigned int threadIdx){
+		vector<IntersectionRecord>& results = threadIdx == 0 ? out : threadResults[threadIdx];
+		for (size_t t = nextTile++; t < tiles.size(); t = nextTile++){
+			const size_t iStart = tiles[t].first * static_cast<size_t>(PAIR_TILE_SIZE);
+			const size_t iEnd = std::min(iStart + PAIR_TILE_SIZE, n);
+			const size_t jStart = tiles[t].second * static_cast<size_t>(PAIR_TILE_SIZE);
+			const size_t jEnd = std::min(jStart + PAIR_TILE_SIZE, n);
+			for (size_t i=iStart; i<iEnd; i++){
+				testAgainstRange_(coords, i, std::max(jStart, i+1), jEnd, [&](size_t j){
+					results.push_back(makeRecord_(coords, i, j));
+				});
 			}
 		}
+	};
+	
+	vector<thread> threads;
+	for (unsigned int k=1; k<numThreads; k++){
+		threads.emplace_back(worker, k);
 	}
-	return intersectVect;
+	worker(0);
+	for (auto& th : threads){
+		th.join();
+	}
+	
+	size_t total = out.size();
+	for (unsigned int k=1; k<numThreads; k++){
+		total += threadResults[k].size();
+	}
+	out.reserve(total);
+	for (unsigned int k=1; k<numThreads; k++){
+		out.insert(out.end(), threadResults[k].begin(), threadResults[k].end());
+	}
+	if (deterministic){
+		std::sort(out.begin() + first, out.end(), [](const IntersectionRecord& a, const IntersectionRecord& b){
+			return a.segA < b.segA || (a.segA == b.segA && a.segB < b.segB);
+		});
+	}
+	positionsToIndices_(coords, out, first);
+}
+
+vector<unique_ptr<PointStruct> > geometry::findAllIntersectionsBruteForceParallel(const vector<shared_ptr<Segment> >& vect,
+																				  unsigned int numThreads, bool deterministic){
+	vector<IntersectionRecord> records;
+	findAllIntersectionsBruteForceParallel(vect, records, numThreads, deterministic);
+	return toPointStructs_(records);
+}
+
+/**	Fraction of all the segment pairs above which the grid search hands over to brute force */
+#define MAX_GRID_PAIR_FRACTION	0.25
+
+/**	Same test as Segment::intersects, for segments i and j of a snapshot
+ */
+static inline bool intersects_(const SegmentSoA& coords, size_t i, size_t j){
+	GEOMETRY_COUNT(SEGMENT_PAIR_TESTS);
+	const float ax1 = coords.x1()[i], ay1 = coords.y1()[i], ax2 = coords.x2()[i], ay2 = coords.y2()[i];
+	const float bx1 = coords.x1()[j], by1 = coords.y1()[j], bx2 = coords.x2()[j], by2 = coords.y2()[j];
+	return orientation(bx1, by1, bx2, by2, ax1, ay1) * orientation(bx1, by1, bx2, by2, ax2, ay2) < 0
+		&& orientation(ax1, ay1, ax2, ay2, bx1, by1) * orientation(ax1, ay1, ax2, ay2, bx2, by2) < 0;
+}
+
+/**	Same as forEachIntersectionBruteForce_, testing only the pairs of segments that share a
+ *	cell of a grid (or all the pairs, if that is most of them anyway)
+ *	@param cellSize	side of the grid's cells (0 means chosen by SegmentGrid)
+ */
+template <typename Callback>
+static void forEachIntersectionGrid_(const SegmentSoA& coords, float cellSize, Callback&& found){
+	const SegmentGrid grid(coords, cellSize);
+	const size_t n = coords.size();
+	
+	//	If most segments share cells (few long segments, dense scene), brute force is faster
+	const double numPairs = 0.5 * static_cast<double>(n) * (n - 1.0);
+	if (grid.getNumCellPairs() > MAX_GRID_PAIR_FRACTION * numPairs){
+		forEachIntersectionBruteForce_(coords, found);
+		return;
+	}
+	
+	/**	For segment i, we collect the segments j>i listed in the cells it crosses.  stamp[j] == i
+	 *	tells that j is already among the candidates, so pairs that share several cells are tested once.
+	 */
+	vector<unsigned int> stamp(n, UINT_MAX);
+	vector<unsigned int> candidates;
+	for (unsigned int i=0; i<n; i++){
+		candidates.clear();
+		grid.forEachCell(coords.x1()[i], coords.y1()[i], coords.x2()[i], coords.y2()[i], [&](unsigned int cell){
+			span<const unsigned int> segs = grid.getCell(cell);
+			for (auto it = std::upper_bound(segs.begin(), segs.end(), i); it != segs.end(); it++){
+				if (stamp[*it] != i){
+					stamp[*it] = i;
+					candidates.push_back(*it);
+				}
+			}
+		});
+		std::sort(candidates.begin(), candidates.end());
+		for (unsigned int j : candidates){
+			if (intersects_(coords, i, j)){
+				found(i, j);
+			}
+		}
+	}
+}
+
+void geometry::findAllIntersectionsGrid(const SegmentSoA& coords, vector<IntersectionRecord>& out,
+										float cellSize, size_t reserveHint, bool append){
+	prepareOutput_(out, reserveHint, append);
+	const size_t first = out.size();
+	forEachIntersectionGrid_(coords, cellSize, [&](size_t i, size_t j){
+		out.push_back(makeRecord_(coords, i, j));
+	});
+	positionsToIndices_(coords, out, first);
+}
+
+void geometry::findAllIntersectionsGrid(const vector<shared_ptr<Segment> >& vect, vector<IntersectionRecord>& out,
+										float cellSize, size_t reserveHint, bool append){
+	findAllIntersectionsGrid(*SegmentSoA::getSnapshot(vect), out, cellSize, reserveHint, append);
+}
+
+void geometry::forEachIntersectionGrid(const SegmentSoA& coords, const function<void(const IntersectionRecord&)>& found,
+									   float cellSize){
+	forEachIntersectionGrid_(coords, cellSize, [&](size_t i, size_t j){
+		IntersectionRecord record = makeRecord_(coords, i, j);
+		record.segA = coords.getIndex(i);
+		record.segB = coords.getIndex(j);
+		found(record);
+	});
 }
+
+vector<unique_ptr<PointStruct> > geometry::findAllIntersectionsGrid(const vector<shared_ptr<Segment> >& vect, float cellSize){
+	vector<IntersectionRecord> records;
+	findAllIntersectionsGrid(vect, records, cellSize);
+	return toPointStructs_(records);
+}
+
+size_t geometry::countAllIntersections(const vector<shared_ptr<Segment> >& vect){
+	const shared_ptr<const SegmentSoA> soa = SegmentSoA::getSnapshot(vect);
+	size_t count = 0;
+	forEachIntersectionGrid_(*soa, 0.f, [&count](size_t, size_t){
+		count++;
+	});
+	return count;
+}
+
 #if 0
 //-----------------------------------------------------------------
 #pragma mark -
@@ -270,92 +524,421 @@ vector<unique_ptr<PointStruct> > geometry::findAllIntersectionsBruteForce(const
 //    return endpointVect;
 //}
 
+/** Tells whether the point (x1, y1) is met by the sweep line before (x2, y2), using the same
+ *  order as compareEvent (top to bottom, then left to right)
+ */
+static inline bool isAbove(float x1, float y1, float x2, float y2){
+    return (y1 > y2) || ((y1 == y2) && (x1 < x2));
+}
+
+/** Tells whether the segment's p2_ is its upper endpoint (the first one met by the sweep line)
+ */
+static inline bool p2IsUpper(const Point& p1, const Point& p2){
+    return isAbove(p2.getX(), p2.getY(), p1.getX(), p1.getY());
+}
+
+/** A horizontal segment is "met" at the sweep point (clamped to the segment) and is placed after all
+ *  the segments through that point.
+ */
+compareSegment::Position geometry::compareSegment::position(const Segment& seg) const{
+    const bool upperIs2 = p2IsUpper(*seg.p1_, *seg.p2_);
+    Position pos;
+    pos.upper = upperIs2 ? seg.p2_.get() : seg.p1_.get();
+    pos.lower = upperIs2 ? seg.p1_.get() : seg.p2_.get();
+    pos.horizontal = pos.upper->getY() == pos.lower->getY();
+    pos.onLine = false;
+    if (pos.horizontal){
+        pos.x = std::clamp(sweep->x, pos.upper->getX(), pos.lower->getX());
+    }else if (sweep->y >= pos.upper->getY()){
+        pos.x = pos.upper->getX();
+    }else if (sweep->y <= pos.lower->getY()){
+        pos.x = pos.lower->getX();
+    }else{
+        pos.x = 0.f;
+        pos.onLine = true;
+    }
+    return pos;
+}
+
+void geometry::compareSegment::locate(const Segment& seg, double& x, double& slope) const{
+    const Position pos = position(seg);
+    const double dy = static_cast<double>(pos.upper->getY()) - pos.lower->getY();
+    const double dx = static_cast<double>(pos.lower->getX()) - pos.upper->getX();
+    slope = pos.horizontal ? HUGE_VAL : dx / dy;
+    if (pos.onLine){
+        x = pos.upper->getX() + dx * ((pos.upper->getY() - static_cast<double>(sweep->y)) / dy);
+    }else{
+        x = pos.x;
+    }
+}
+
+int geometry::compareSegment::compareDirection(const Position& pos1, const Position& pos2){
+    if (pos1.horizontal || pos2.horizontal){
+        return static_cast<int>(pos1.horizontal) - static_cast<int>(pos2.horizontal);
+    }
+    return slopeOrder(pos1.upper->getX(), pos1.upper->getY(), pos1.lower->getX(), pos1.lower->getY(),
+                      pos2.upper->getX(), pos2.upper->getY(), pos2.lower->getX(), pos2.lower->getY());
+}
+
+bool geometry::compareSegment::isSameX(double x1, double x2){
+    return fabs(x1 - x2) <= Geometry::DISTANCE_ABS_TOL + Geometry::DISTANCE_REL_TOL * std::max(fabs(x1), fabs(x2));
+}
+
+/** The segments are ordered by the exact x of their positions, then by direction (a horizontal
+ *  segment last), then by index: a strict weak order for any position of the sweep line.
+ */
+bool geometry::compareSegment::operator()(const shared_ptr<Segment>& s1, const shared_ptr<Segment>& s2) const{
+    GEOMETRY_COUNT(SWEEP_STATUS_COMPARISONS);
+    if (s1 == s2){
+        return false;
+    }
+    const Position pos1 = position(*s1);
+    const Position pos2 = position(*s2);
+    const float y = sweep->y;
+    int order;
+    if (pos1.onLine && pos2.onLine){
+        order = lineOrder(pos1.upper->getX(), pos1.upper->getY(), pos1.lower->getX(), pos1.lower->getY(),
+                          pos2.upper->getX(), pos2.upper->getY(), pos2.lower->getX(), pos2.lower->getY(), y);
+    }else if (pos1.onLine){
+        //  the orientation of (pos2.x, y) with respect to the downward segment 1 has the sign of x1 - pos2.x
+        order = orientation(pos1.upper->getX(), pos1.upper->getY(), pos1.lower->getX(), pos1.lower->getY(), pos2.x, y);
+    }else if (pos2.onLine){
+        order = -orientation(pos2.upper->getX(), pos2.upper->getY(), pos2.lower->getX(), pos2.lower->getY(), pos1.x, y);
+    }else{
+        order = (pos1.x > pos2.x) - (pos1.x < pos2.x);
+    }
+    if (order == 0){
+        order = compareDirection(pos1, pos2);
+    }
+    if (order != 0){
+        return order < 0;
+    }
+    return s1->idx_ < s2->idx_;
+}
+
 std::set<std::shared_ptr<InterQueueEvent> , compareEvent> geometry::buildEventSet(const std::vector<std::shared_ptr<Segment> >& vect){
-//    vector<shared_ptr<Point> > endpointVect = getAllEndPoints(vect);
     std::set<std::shared_ptr<InterQueueEvent> , compareEvent> eventQueue;
         for (auto itr = vect.begin(); itr != vect.end(); itr++){
+            const shared_ptr<Point>& p1 = (*itr)->getP1();
+            const shared_ptr<Point>& p2 = (*itr)->getP2();
+            /** A degenerate segment can't properly intersect anything */
+            if (p1->getX() == p2->getX() && p1->getY() == p2->getY()){
+                continue;
+            }
+            const bool upperIs2 = p2IsUpper(*p1, *p2);
             const std::shared_ptr<InterQueueEvent> endPt1 = make_shared<InterQueueEvent>();
             const std::shared_ptr<InterQueueEvent> endPt2 = make_shared<InterQueueEvent>();
-//            static const std::set<std::shared_ptr<Point> >& allPointSet = Point::getAllPoints();
-//            std::shared_ptr<Point> currPoint = allPointSet.find(&(*itr)->getP1());
-            endPt1->endpt = (*itr)->getP1();
+            endPt1->endpt = p1;
             endPt1->isIntersection = false;
+            endPt1->isUpper = !upperIs2;
+            endPt1->seg = *itr;
             eventQueue.insert(endPt1);
+            GEOMETRY_COUNT(SWEEP_QUEUE_INSERTS);
             
-            endPt2->endpt = (*itr)->getP2();
+            endPt2->endpt = p2;
             endPt2->isIntersection = false;
+            endPt2->isUpper = upperIs2;
+            endPt2->seg = *itr;
             eventQueue.insert(endPt2);
+            GEOMETRY_COUNT(SWEEP_QUEUE_INSERTS);
         }
     return eventQueue;
 }
 
-void geometry::addEvent(set<shared_ptr<InterQueueEvent> , compareEvent>& eventQueue,shared_ptr<PointStruct> currInterPt){
-    const std::shared_ptr<InterQueueEvent> currPoint;
+void geometry::addEvent(set<shared_ptr<InterQueueEvent> , compareEvent>& eventQueue,shared_ptr<PointStruct> currInterPt,
+                        const shared_ptr<Segment>& seg1, const shared_ptr<Segment>& seg2){
+    const std::shared_ptr<InterQueueEvent> currPoint = make_shared<InterQueueEvent>();
     currPoint->interPt = currInterPt;
     currPoint->isIntersection = true;
+    currPoint->isUpper = false;
+    /** store the pair in a canonical order so that the event compares consistently */
+    if (seg1->getIndex() < seg2->getIndex()){
+        currPoint->seg = seg1;
+        currPoint->otherSeg = seg2;
+    }else{
+        currPoint->seg = seg2;
+        currPoint->otherSeg = seg1;
+    }
     eventQueue.insert(currPoint);
-}
-void geometry::orderMap(std::map<int,unsigned int> prioritySegMap,const vector<shared_ptr<Segment> >& segVect,shared_ptr<InterQueueEvent> currPoint){
-    
-////  go through all the segments and see which if they are on the left or right of the segment that they are supposed to check
-//    for(auto itr = prioritySegMap.begin(); itr != prioritySegMap.end(); itr++){
-//        unsigned int currSeg = (itr)->second;
-//        auto itr2 = std::next(itr,1);
-//        unsigned int nextSeg = (itr2)->second;
-//    //    if next seg is on left side of curr point then swap priorities
-//        int tempPriority = 0;
-//        if(segVect[nextSeg]->isOnLeftSide(currPoint->endpt)){
-//            tempPriority = prioritySegMap[itr]->first;
-//            prioritySegMap[itr2]->first = prioritySegMap[itr]->first;
-//            prioritySegMap[itr]->first = tempPriority;
-//        }
-//    }
+    GEOMETRY_COUNT(SWEEP_QUEUE_INSERTS);
 }
 
-vector<unique_ptr<PointStruct> > geometry::findAllIntersectionsSmart(const vector<shared_ptr<Segment> >& segVect){
-    
-    vector<unique_ptr<PointStruct> > intersectVect;
+/** The plane sweep behind findAllIntersectionsSmart and anyIntersection.
+ *  @param segVect - the segments whose intersections need to be found
+ *  @param out - the buffer that receives the intersections, or nullptr to stop at the first
+ *          intersection found (Shamos-Hoey: the first pair of neighbors on the sweep line that intersect)
+ *  @return true if an intersection was found
+ */
+static bool sweepIntersections_(const vector<shared_ptr<Segment> >& segVect, vector<IntersectionRecord>* out){
+    bool found = false;
     //    Call this function to populate the segmentPoints
     std::set<std::shared_ptr<InterQueueEvent> , compareEvent> eventQueue = buildEventSet(segVect);
+    
 	//   The T data structure is a set of shared pointers to segments and compare function that will sort the segments
-	std::set<shared_ptr<Segment>,compareSegment> prioritySegSet;
-	int segPriority = 0;
-//	for(auto itr = eventQueue.begin(); itr != eventQueue.end(); itr++){
-//		std::shared_ptr<InterQueueEvent> currPoint = *itr;
-//        std::set<unsigned int> currSegSet;
-//		//Get the segmentlist of each point and push it in the priority seg map according to the order
-//		if(!(*currPoint).isIntersection){
-//			currSegSet = (currPoint->endpt)->getSegList();
-//		}
-//        //if it is the first endpt, put it in the map
-//        if(currPoint->isFirst){
-//            //populate segMap
-//            //if segList size is larger than one then execute this loop to add them all
-//            if(currSegSet.size()>1){
-//                for(auto segItr = currSegSet.begin(); segItr != currSegSet.end(); segItr++){
-//                    prioritySegMap[segPriority] = *(segItr);
-//                    segPriority++;
-//                }
-//            }else{
-//                prioritySegMap[segPriority] = *(currSegSet.begin());
-//            }
-//
-//            //if only one segment in map then continue
-//            if(prioritySegMap.size() == 1){
-//                continue;
-//            }else{
-//                // if there are more than one segments in the map then sort them
-//                orderMap(prioritySegMap,segVect,currPoint);
-//            }
-//        }else{
-//            //remove the segment from the map, if we are on the second endpt
-//            for (auto mapItr= prioritySegMap.begin(); mapItr!=prioritySegMap.end(); mapItr++){
-//                if(mapItr->second == currPoint->segIdx){
-//                    prioritySegMap.erase(mapItr->first);
-//                }
-//            }
-//        }
-//        segPriority++;
-//	}
-    return intersectVect;
+	//   along the sweep line.  We keep an iterator to each segment's node so that removing a segment never relies
+	//   on the comparison (the order of two segments changes when we cross their intersection point)
+	SweepLine sweep{-HUGE_VALF, HUGE_VALF};
+	using StatusSet = std::set<shared_ptr<Segment>,compareSegment>;
+	StatusSet prioritySegSet(compareSegment{&sweep});
+	unordered_map<unsigned int, StatusSet::iterator> statusPos;
+	statusPos.reserve(segVect.size());
+	
+	//   Pairs of segments whose intersection was already found (keyed like Segment::segIndex_).
+	//   Two segments can become neighbors several times, but their intersection must be reported once
+	unordered_set<uint64_t> foundPairs;
+	
+	//   Intersections found "above" the sweep line because of roundoff.  They are processed right away,
+	//   before we move the sweep line any further.
+	std::set<std::shared_ptr<InterQueueEvent> , compareEvent> lateQueue;
+
+	auto checkPair = [&](StatusSet::iterator left, StatusSet::iterator right){
+		const shared_ptr<Segment>& s1 = *left;
+		const shared_ptr<Segment>& s2 = *right;
+		const uint64_t key = s1->getIndex() < s2->getIndex() ?
+							(static_cast<uint64_t>(s1->getIndex()) << 32) | s2->getIndex() :
+							(static_cast<uint64_t>(s2->getIndex()) << 32) | s1->getIndex();
+		if (foundPairs.count(key) != 0){
+			return;
+		}
+		/** computed from the horizontal segment, if there is one, so that the event is exactly on
+		 *  its line, and met before its lower endpoint
+		 */
+		const bool isHorizontal2 = s2->getP1()->getY() == s2->getP2()->getY();
+		PointStruct interPt;
+		if ((isHorizontal2 ? s2 : s1)->findIntersection(isHorizontal2 ? *s1 : *s2, interPt)){
+			found = true;
+			foundPairs.insert(key);
+			if (isAbove(interPt.x, interPt.y, sweep.x, sweep.y)){
+				addEvent(lateQueue, make_shared<PointStruct>(interPt), s1, s2);
+			}else{
+				addEvent(eventQueue, make_shared<PointStruct>(interPt), s1, s2);
+			}
+		}
+	};
+	/** Check a segment against its neighbors on the sweep line.  Because of roundoff, segments that
+	 *  meet the sweep line at (almost) the same location may not be in the right order yet, so we
+	 *  check the segment against all of these, and then against the first segment beyond them.
+	 */
+	auto checkNeighbors = [&](StatusSet::iterator it){
+		const compareSegment& comp = prioritySegSet.key_comp();
+		double x0, x, slope;
+		comp.locate(**it, x0, slope);
+		for (auto left = it; left != prioritySegSet.begin(); ){
+			--left;
+			checkPair(left, it);
+			comp.locate(**left, x, slope);
+			if (!compareSegment::isSameX(x, x0)){
+				break;
+			}
+		}
+		for (auto right = std::next(it); right != prioritySegSet.end(); right++){
+			checkPair(it, right);
+			comp.locate(**right, x, slope);
+			if (!compareSegment::isSameX(x, x0)){
+				break;
+			}
+		}
+	};
+	/** Tells whether two segments that intersect are in the order they have below their intersection
+	 *  point: the one that goes more to the right on the right
+	 */
+	auto haveCrossed = [&](const shared_ptr<Segment>& s1, const shared_ptr<Segment>& s2){
+		const compareSegment& comp = prioritySegSet.key_comp();
+		return comp(s1, s2) == (compareSegment::compareDirection(comp.position(*s1), comp.position(*s2)) < 0);
+	};
+	/** Tells whether a segment of the sweep line is still in order with its neighbors */
+	auto isInPlace = [&](StatusSet::iterator it){
+		const compareSegment& comp = prioritySegSet.key_comp();
+		return (it == prioritySegSet.begin() || comp(*std::prev(it), *it)) &&
+			   (std::next(it) == prioritySegSet.end() || comp(*it, *std::next(it)));
+	};
+	/** Gets the segments on either side of a segment on the sweep line, nullptr if there is none
+	 *  (or if the segment is not on the sweep line)
+	 */
+	auto getNeighbors = [&](const shared_ptr<Segment>& seg, const Segment*& left, const Segment*& right){
+		auto pos = statusPos.find(seg->getIndex());
+		if (pos == statusPos.end()){
+			return;
+		}
+		if (pos->second != prioritySegSet.begin()){
+			left = std::prev(pos->second)->get();
+		}
+		if (std::next(pos->second) != prioritySegSet.end()){
+			right = std::next(pos->second)->get();
+		}
+	};
+	/** Check a segment put back on the sweep line against the segments it passed over: those between its
+	 *  new place and the neighbors it had before (nullptr at the ends of the sweep line).  Between two
+	 *  float ordinates, a nearly horizontal segment can cross several others at once.  We walk both ways
+	 *  until we meet an old neighbor: if it is the one of the other side, the segment moved past it, and
+	 *  we go on in that direction until we meet the other one.  The old neighbors are then next to
+	 *  each other.
+	 */
+	auto checkPassed = [&](StatusSet::iterator it, const Segment* left, const Segment* right){
+		StatusSet::iterator l = it, r = std::next(it);
+		bool walkLeft = true, walkRight = true, moved = false;
+		while (walkLeft || walkRight){
+			if (walkLeft){
+				if (l == prioritySegSet.begin()){
+					walkLeft = false;
+				}else if ((--l)->get() == left){
+					walkLeft = false;
+				}else{
+					checkPair(l, it);
+					if (l->get() == right){
+						walkRight = false;
+						moved = true;
+					}
+				}
+			}
+			if (walkRight){
+				if (r == prioritySegSet.end() || r->get() == right){
+					walkRight = false;
+				}else{
+					checkPair(it, r);
+					if (r->get() == left){
+						walkLeft = false;
+						moved = true;
+					}
+					++r;
+				}
+			}
+		}
+		if (moved && left != nullptr && right != nullptr){
+			checkPair(statusPos.at(left->getIndex()), statusPos.at(right->getIndex()));
+		}
+	};
+	auto insertSegment = [&](const shared_ptr<Segment>& seg){
+		StatusSet::iterator it = prioritySegSet.insert(seg).first;
+		statusPos[seg->getIndex()] = it;
+		return it;
+	};
+	/** remove a segment from the sweep line, if it's there
+	 *  @return true if the segment was on the sweep line
+	 */
+	auto removeSegment = [&](const shared_ptr<Segment>& seg){
+		auto pos = statusPos.find(seg->getIndex());
+		if (pos == statusPos.end()){
+			return false;
+		}
+		prioritySegSet.erase(pos->second);
+		statusPos.erase(pos);
+		return true;
+	};
+
+	while ((!eventQueue.empty() || !lateQueue.empty()) && (out != nullptr || !found)){
+		shared_ptr<InterQueueEvent> currPoint;
+		GEOMETRY_COUNT(SWEEP_QUEUE_POPS);
+		if (!lateQueue.empty()){
+			currPoint = *lateQueue.begin();
+			lateQueue.erase(lateQueue.begin());
+		}else{
+			currPoint = *eventQueue.begin();
+			eventQueue.erase(eventQueue.begin());
+			sweep.x = currPoint->getX();
+			sweep.y = currPoint->getY();
+		}
+
+		if (!currPoint->isIntersection){
+			if (currPoint->isUpper){
+				checkNeighbors(insertSegment(currPoint->seg));
+			}else{
+				/** the two segments on either side of the one we remove become neighbors */
+				auto pos = statusPos.find(currPoint->seg->getIndex());
+				if (pos != statusPos.end() && !isInPlace(pos->second)){
+					/** A nearly horizontal segment may have passed over others since it was put back on
+					 *  the sweep line: move it to its place to check them first.
+					 */
+					const Segment* left = nullptr;
+					const Segment* right = nullptr;
+					getNeighbors(currPoint->seg, left, right);
+					removeSegment(currPoint->seg);
+					checkPassed(insertSegment(currPoint->seg), left, right);
+					pos = statusPos.find(currPoint->seg->getIndex());
+				}
+				if (pos != statusPos.end()){
+					StatusSet::iterator next = std::next(pos->second);
+					bool hasPrev = pos->second != prioritySegSet.begin();
+					StatusSet::iterator prev = hasPrev ? std::prev(pos->second) : prioritySegSet.end();
+					prioritySegSet.erase(pos->second);
+					statusPos.erase(pos);
+					if (hasPrev && next != prioritySegSet.end()){
+						checkPair(prev, next);
+					}
+				}
+			}
+		}else{
+			if (!currPoint->isDelayed){
+				/** The point of the event may have been computed from the other segment: the point of
+				 *  the record is computed from the segment of lower index (seg), as the brute force does.
+				 */
+				PointStruct interPt;
+				if (!currPoint->seg->findIntersection(*currPoint->otherSeg, interPt)){
+					interPt = *(currPoint->interPt);
+				}
+				const unsigned int idx1 = currPoint->seg->getIndex(), idx2 = currPoint->otherSeg->getIndex();
+				out->push_back(IntersectionRecord{interPt.x, interPt.y, std::min(idx1, idx2), std::max(idx1, idx2)});
+			}
+
+			/** Past the intersection point, the two segments swap places on the sweep line: take
+			 *  them out and put them back in, in their exact order on the sweep line.
+			 */
+			const Segment* left1 = nullptr;
+			const Segment* right1 = nullptr;
+			const Segment* left2 = nullptr;
+			const Segment* right2 = nullptr;
+			getNeighbors(currPoint->seg, left1, right1);
+			getNeighbors(currPoint->otherSeg, left2, right2);
+			const bool hadSeg = removeSegment(currPoint->seg);
+			const bool hadOther = removeSegment(currPoint->otherSeg);
+			StatusSet::iterator it1 = prioritySegSet.end(), it2 = prioritySegSet.end();
+			if (hadSeg){
+				it1 = insertSegment(currPoint->seg);
+			}
+			if (hadOther){
+				it2 = insertSegment(currPoint->otherSeg);
+			}
+			/** The intersection point is rounded, so the segments may not have crossed yet at the
+			 *  sweep point: then we try again just after it, until they have.  A horizontal segment
+			 *  only crosses the others while the sweep point moves along it.
+			 */
+			if (hadSeg && hadOther && !haveCrossed(currPoint->seg, currPoint->otherSeg)){
+				const std::shared_ptr<InterQueueEvent> retry = make_shared<InterQueueEvent>(*currPoint);
+				const compareSegment& comp = prioritySegSet.key_comp();
+				if (comp.position(*currPoint->seg).horizontal || comp.position(*currPoint->otherSeg).horizontal){
+					retry->interPt = make_shared<PointStruct>(std::max(nextafterf(sweep.x, HUGE_VALF), currPoint->interPt->x), sweep.y);
+				}else{
+					retry->interPt = make_shared<PointStruct>(currPoint->interPt->x, nextafterf(sweep.y, -HUGE_VALF));
+				}
+				retry->isDelayed = true;
+				eventQueue.insert(retry);
+				GEOMETRY_COUNT(SWEEP_QUEUE_INSERTS);
+			}
+			if (hadSeg){
+				checkPassed(it1, left1, right1);
+				checkNeighbors(it1);
+			}
+			if (hadOther){
+				checkPassed(it2, left2, right2);
+				checkNeighbors(it2);
+			}
+		}
+	}
+	return found;
+}
+
+void geometry::findAllIntersectionsSmart(const vector<shared_ptr<Segment> >& segVect, vector<IntersectionRecord>& out,
+                                         size_t reserveHint, bool append){
+    prepareOutput_(out, reserveHint, append);
+    sweepIntersections_(segVect, &out);
+}
+
+bool geometry::anyIntersection(const vector<shared_ptr<Segment> >& segVect){
+    return sweepIntersections_(segVect, nullptr);
+}
+
+vector<unique_ptr<PointStruct> > geometry::findAllIntersectionsSmart(const vector<shared_ptr<Segment> >& segVect){
+    vector<IntersectionRecord> records;
+    findAllIntersectionsSmart(segVect, records);
+    return toPointStructs_(records);
 }
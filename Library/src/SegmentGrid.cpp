@@ -0,0 +1,96 @@
+//
+//  SegmentGrid.cpp
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "SegmentGrid.hpp"
+
+using namespace std;
+using namespace geometry;
+
+/**	Upper bound on the number of cells per segment, whatever the cell size requested */
+#define MAX_CELLS_PER_SEGMENT	16
+
+SegmentGrid::SegmentGrid(const SegmentSoA& soa, float cellSize)
+	:	xmin_(0.f),
+		ymin_(0.f),
+		cellSize_(1.f),
+		pad_(0.f),
+		numCols_(1),
+		numRows_(1)
+{
+	const size_t n = soa.size();
+	float xmax = 0.f, ymax = 0.f;
+	if (n > 0){
+		xmin_ = ymin_ = HUGE_VALF;
+		xmax = ymax = -HUGE_VALF;
+		for (size_t k=0; k<n; k++){
+			xmin_ = fminf(xmin_, fminf(soa.x1()[k], soa.x2()[k]));
+			xmax = fmaxf(xmax, fmaxf(soa.x1()[k], soa.x2()[k]));
+			ymin_ = fminf(ymin_, fminf(soa.y1()[k], soa.y2()[k]));
+			ymax = fmaxf(ymax, fmaxf(soa.y1()[k], soa.y2()[k]));
+		}
+	}
+	const float width = xmax - xmin_, height = ymax - ymin_;
+	cellSize_ = cellSize > 0.f ? cellSize : chooseCellSize(soa, width, height);
+	pad_ = 1E-5f * fmaxf(fmaxf(width, height),
+						 fmaxf(fmaxf(fabsf(xmin_), fabsf(xmax)), fmaxf(fabsf(ymin_), fabsf(ymax))));
+	
+	const double maxCells = MAX_CELLS_PER_SEGMENT * static_cast<double>(n) + 1024.0;
+	double cols = floor(width / cellSize_) + 1.0, rows = floor(height / cellSize_) + 1.0;
+	if (cols * rows > maxCells){
+		const double scale = sqrt(cols * rows / maxCells);
+		cellSize_ = static_cast<float>(cellSize_ * scale * 1.01);
+		cols = floor(width / cellSize_) + 1.0;
+		rows = floor(height / cellSize_) + 1.0;
+	}
+	numCols_ = static_cast<unsigned int>(cols);
+	numRows_ = static_cast<unsigned int>(rows);
+	
+	//	Two passes over the segments: count the segments per cell, then fill the cells
+	cellStart_.assign(getNumCells() + 1, 0);
+	for (size_t k=0; k<n; k++){
+		forEachCell(soa.x1()[k], soa.y1()[k], soa.x2()[k], soa.y2()[k], [&](unsigned int cell){
+			cellStart_[cell+1]++;
+		});
+	}
+	for (unsigned int c=0; c<getNumCells(); c++){
+		cellStart_[c+1] += cellStart_[c];
+	}
+	cellSegs_.resize(cellStart_[getNumCells()]);
+	vector<unsigned int> fill(cellStart_.begin(), cellStart_.end()-1);
+	for (unsigned int k=0; k<n; k++){
+		forEachCell(soa.x1()[k], soa.y1()[k], soa.x2()[k], soa.y2()[k], [&](unsigned int cell){
+			cellSegs_[fill[cell]++] = k;
+		});
+	}
+}
+
+float SegmentGrid::chooseCellSize(const SegmentSoA& soa, float width, float height){
+	if (soa.size() == 0){
+		return 1.f;
+	}
+	vector<float> lengths(soa.size());
+	for (size_t k=0; k<soa.size(); k++){
+		lengths[k] = hypotf(soa.x2()[k] - soa.x1()[k], soa.y2()[k] - soa.y1()[k]);
+	}
+	auto median = lengths.begin() + lengths.size()/2;
+	std::nth_element(lengths.begin(), median, lengths.end());
+	
+	//	at most about 4 cells per segment
+	const double n = static_cast<double>(soa.size());
+	float cellSize = fmaxf(*median, static_cast<float>(fmax(sqrt(static_cast<double>(width) * height / (4.0*n)),
+																fmax(width, height) / (4.0*n))));
+	return cellSize > 0.f ? cellSize : 1.f;
+}
+
+double SegmentGrid::getNumCellPairs(void) const{
+	double numPairs = 0.0;
+	for (unsigned int c=0; c<getNumCells(); c++){
+		const double count = cellStart_[c+1] - cellStart_[c];
+		numPairs += count * (count - 1.0) / 2.0;
+	}
+	return numPairs;
+}
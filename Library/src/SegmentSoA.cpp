@@ -0,0 +1,88 @@
+//
+//  SegmentSoA.cpp
+//
+
+#include <new>
+#include <algorithm>
+
+#include "SegmentSoA.hpp"
+#include "Scene.hpp"
+#include "OrientationKernel.hpp"
+
+using namespace std;
+using namespace geometry;
+
+void SegmentSoA::AlignedDelete_::operator()(float* block) const{
+	::operator delete[](block, std::align_val_t(ALIGNMENT));
+}
+
+SegmentSoA::SegmentSoA(const vector<shared_ptr<Segment> >& vect)
+	:	size_(vect.size()),
+		//	round up to a multiple of the alignment, plus one batch of padding
+		stride_((vect.size() + ORIENTATION_BATCH_SIZE + ALIGNMENT/sizeof(float) - 1) / (ALIGNMENT/sizeof(float))
+				* (ALIGNMENT/sizeof(float))),
+		block_(static_cast<float*>(::operator new[](4 * stride_ * sizeof(float), std::align_val_t(ALIGNMENT)))),
+		x1_(block_.get()),
+		y1_(block_.get() + stride_),
+		x2_(block_.get() + 2*stride_),
+		y2_(block_.get() + 3*stride_),
+		index_(vect.size())
+{
+	float* x1 = block_.get();
+	float* y1 = x1 + stride_;
+	float* x2 = y1 + stride_;
+	float* y2 = x2 + stride_;
+	for (size_t k=0; k<size_; k++){
+		const Point& p1 = *(vect[k]->getP1());
+		const Point& p2 = *(vect[k]->getP2());
+		x1[k] = p1.getX();
+		y1[k] = p1.getY();
+		x2[k] = p2.getX();
+		y2[k] = p2.getY();
+		index_[k] = vect[k]->getIndex();
+	}
+	for (float* array : {x1, y1, x2, y2}){
+		std::fill(array + size_, array + stride_, 0.f);
+	}
+}
+
+SegmentSoA::SegmentSoA(span<const SegmentCoords> segs)
+	:	size_(segs.size()),
+		stride_((segs.size() + ORIENTATION_BATCH_SIZE + ALIGNMENT/sizeof(float) - 1) / (ALIGNMENT/sizeof(float))
+				* (ALIGNMENT/sizeof(float))),
+		block_(static_cast<float*>(::operator new[](4 * stride_ * sizeof(float), std::align_val_t(ALIGNMENT)))),
+		x1_(block_.get()),
+		y1_(block_.get() + stride_),
+		x2_(block_.get() + 2*stride_),
+		y2_(block_.get() + 3*stride_),
+		index_(segs.size())
+{
+	float* x1 = block_.get();
+	float* y1 = x1 + stride_;
+	float* x2 = y1 + stride_;
+	float* y2 = x2 + stride_;
+	for (size_t k=0; k<size_; k++){
+		x1[k] = segs[k].x1;
+		y1[k] = segs[k].y1;
+		x2[k] = segs[k].x2;
+		y2[k] = segs[k].y2;
+		index_[k] = segs[k].idx;
+	}
+	for (float* array : {x1, y1, x2, y2}){
+		std::fill(array + size_, array + stride_, 0.f);
+	}
+}
+
+shared_ptr<const SegmentSoA> SegmentSoA::getSnapshot(void){
+	return Scene::getDefault().getSnapshot();
+}
+
+shared_ptr<const SegmentSoA> SegmentSoA::getSnapshot(const vector<shared_ptr<Segment> >& vect){
+	if (!vect.empty()){
+		Scene& scene = vect[0]->getScene();
+		if (&vect == &scene.getAllSegments()){
+			return scene.getSnapshot();
+		}
+	}
+	return make_shared<const SegmentSoA>(vect);
+}
@@ -3,6 +3,7 @@
 
 #include <cmath>
 #include "Point.hpp"
+#include "Segment.hpp"
 
 /** Essentially a set of application-wide global variables defining the
  * dimensions of the "world" and the conversion factors from pixel to world
@@ -140,6 +141,10 @@ struct World {
 
 		POINT_DISK_RADIUS = POINT_PIXEL_RADIUS * PIXEL_TO_WORLD;
 		geometry::Point::setPointDiskRadius(POINT_DISK_RADIUS);
+		/**	about 1000 cells across the world for the duplicate-point grid */
+		geometry::Point::setGridCellSize(fmaxf(WORLD_WIDTH, WORLD_HEIGHT) / 1024.f);
+		/**	and about 64 cells across for the index used by the live intersections */
+		geometry::Segment::setIndexCellSize(fmaxf(WORLD_WIDTH, WORLD_HEIGHT) / 64.f);
 		
 		// snap stuff
 		SNAP_TO_POINT_TOL = 1.5f*POINT_DISK_RADIUS;
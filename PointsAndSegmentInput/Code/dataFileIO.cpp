@@ -4,190 +4,65 @@
 //
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
-#include <cstdio>
-#include <limits>
-#include <vector>
+#include <filesystem>
 #include "dataFileIO.hpp"
 #include "World.hpp"
-#include "Point.hpp"
-#include "Segment.hpp"
+#include "Scene.hpp"
+#include "SceneFile.hpp"
 
 using namespace std;
 using namespace geometry;
 
-string getNextDataLine(ifstream& inFile);
-float getWorldDimension(const string& line, const string& label);
+int readDataFile(const string& filePath, int& paneWidth, int& paneHeight){
 
-static const unsigned long NOT_FOUND = numeric_limits<string::size_type>::max();
-
-
-void readDataFile(const string& filePath, int& paneWidth, int& paneHeight){
-
-	ifstream inFile(filePath.c_str());
-	if (!inFile.is_open()){
-		cout << "File not found: " << filePath << endl;
-		exit(7);
+	SceneFileError error;
+	/**	Binary scene files are used in place */
+	if (isBinarySceneFile(filePath)){
+		BinarySceneFile file;
+		if (file.open(filePath, error) != SceneFileStatus::OK){
+			cout << error.message << endl;
+			return static_cast<int>(error.status);
+		}
+		World::setWorldBounds(file.getXmin(), file.getXmax(), file.getYmin(), file.getYmax(), paneWidth, paneHeight);
+		addToScene(file, Scene::getDefault());
+		return 0;
 	}
-	
-	string line;
-	
-	//-----------------------------------------------------
-	//	Section 1:	World Bounds
-	//-----------------------------------------------------
-	float xmin, xmax, ymin, ymax;
-	line = getNextDataLine(inFile);
-	xmin = getWorldDimension(line, "XMIN");
-	line = getNextDataLine(inFile);
-	xmax = getWorldDimension(line, "XMAX");
-	line = getNextDataLine(inFile);
-	ymin = getWorldDimension(line, "YMIN");
-	line = getNextDataLine(inFile);
-	ymax = getWorldDimension(line, "YMAX");
-	World::setWorldBounds(xmin, xmax, ymin, ymax, paneWidth, paneHeight);
-	
-	//-----------------------------------------------------
-	//	Section 2:	Point list
-	//-----------------------------------------------------
-	
-	/**	A local copy of the global point list, to be able to access them by index when we create segments.*/
-	vector<shared_ptr<Point> > pointList;
 
-	bool readingPointData = true;
-	while (readingPointData){
-		/**	We get the next line of data (so, not a blank line and not a comment line, so the first non-blank character will be "meaningful"*/
-		line  = getNextDataLine(inFile);
-		
-		/**	if the first non-blank character is anything other than 'p' or 'v', then we are done with point data.*/
-		char c = line[line.find_first_not_of(' ')];
-		if ((c == 'p') || (c == 'v')){
-			//	read the point's coordinates
-			istringstream iSStr(line);
-			string word;
-			float x, y;
-			iSStr >> word >> x >> y;
-			if ((word == "v") || (word == "p")){
-				/**	Create the point */
-				pointList.push_back(Point::makeNewPointPtr(x, y));
-			}else{
-				cout << "Invalid Point coordinates format line: " << line << endl;
-				cout << "\tExpected format: v|p" <<  " <float value> <float value>" << endl;
-				exit(8);
-			}
-		}else{
-			readingPointData = false;
-		}
+	SceneFileData data;
+	if (readSceneFile(filePath, data, error) != SceneFileStatus::OK){
+		cout << error.message << endl;
+		return static_cast<int>(error.status);
 	}
-	
-	//-----------------------------------------------------
-	//	Section 3:	Segment list
-	//-----------------------------------------------------
-	/**	We came out of the Point section with a non-blank, non-comment line that hasn't been processed yet. */
-	bool readingSegmentData = true;
-	do{
-		
-		/**	if the first non-blank character is anything other than 'p' or 'v', then we are done with point data.*/
-		char c = line[line.find_first_not_of(' ')];
-        if (c == 's') {
-            /**	read the segment's endpoints' indices */
-            istringstream iSStr(line);
-            string word;
-            size_t index1, index2;
-            iSStr >> word >> index1 >> index2;
-            if ((word == "s")){
-                /**	Create the point */
-                Segment::makeNewSeg((pointList[index1]), (pointList[index2]));
-            }else{
-                cout << "Invalid Segment format line: " << line << endl;
-                cout << "\tExpected format: s  <point index 1> <point index 2>" << endl;
-                exit(8);
-            }
-            /**As soon as we encounter a non-blank line that doesn’t define a segment, this section is over */
-        }else{
-			readingSegmentData = false;
-		}
-	} while (readingSegmentData && getline(inFile, line));
 
-	//-----------------------------------------------------
-	//	Section 4:	We're done
-	//-----------------------------------------------------
-	/**	At this moment, the file format only defines points and segments*/
-	inFile.close();
-	
-	//	really just to be nice
-	pointList.clear();
+	World::setWorldBounds(data.xmin, data.xmax, data.ymin, data.ymax, paneWidth, paneHeight);
+	addToScene(data, Scene::getDefault());
+	return 0;
 }
 
-string writeDataFile(const string& rootFilePath){
-
-	string outFilePath;
-	int nextFileIndex = 2;
-	ostringstream outStream;
-	outStream << rootFilePath << ".txt";
-	bool fileNameNotFound = true;
-	do{
-		outFilePath = outStream.str();
-		ofstream outFile(outFilePath);
-		if (outFile.is_open()){
-			outFile.close();
-			fileNameNotFound = false;
-		}
-		else{
-			outStream.clear();
-			outStream << rootFilePath << "-" << nextFileIndex << ".txt";
-		}
-	}while (fileNameNotFound);
-	
-	ofstream outFile(outFilePath);
-	outFile << "#====================================" << endl;
-	outFile << "#  Segment Intersection Scene " << endl;
-	outFile << "#      recorded " << endl;
-	outFile << "#====================================" << endl<< endl;
-	
-	outFile << "#  Point List" << endl;
-	outFile << "#------------" << endl;
-	
-	
-
-	outFile.close();
-	return outFilePath;
-}
+string writeDataFile(const string& rootFilePath, const vector<IntersectionRecord>* intersections){
 
-string getNextDataLine(ifstream& inFile){
-	bool stilSearching = true;
-	string line;
-	while (stilSearching && getline(inFile, line)) {
-		/**	Find the first non-space character */
-		string::size_type pos = line.find_first_not_of(' ');
-		
-		/** If the line contains any non-space chars */
-		if (pos != NOT_FOUND){
-			/**	Skip if the first no-blank character indicates a comment line */
-			if (line[pos] != '#'){
-				stilSearching = false;
-			}
-		}
+	/**	Don't overwrite a scene saved earlier: use the first of root.txt, root-2.txt,
+	 *	root-3.txt... that doesn't exist yet.
+	 */
+	string outFilePath = rootFilePath + ".txt";
+	for (int nextFileIndex = 2; filesystem::exists(outFilePath); nextFileIndex++){
+		outFilePath = rootFilePath + "-" + to_string(nextFileIndex) + ".txt";
 	}
-	/**	if we were still searching when we left the loop, it's because we reached the end of the file --> return an empty string */
-	if (stilSearching) {
-		line = "";
+
+	SceneFileData data;
+	data.xmin = World::X_MIN;
+	data.xmax = World::X_MAX;
+	data.ymin = World::Y_MIN;
+	data.ymax = World::Y_MAX;
+	copyFromScene(Scene::getDefault(), data);
+	if (intersections != nullptr){
+		data.intersections = *intersections;
 	}
-	
-	return line;
-}
 
-float getWorldDimension(const string& line, const string& label){
-	istringstream iSStr(line);
-	string firstWord, eqStr;
-	float val;
-	iSStr >> firstWord >> eqStr >> val;
-	if ((firstWord != label) || (eqStr != "=")){
-		cout << "Invalid World Bound format line: " << line << endl;
-		cout << "\tExpected format: " << label << " = <float value>" << endl;
-		exit(9);
+	SceneFileError error;
+	if (writeSceneFile(outFilePath, data, error) != SceneFileStatus::OK){
+		cout << error.message << endl;
+		return "";
 	}
-	
-	/** If I was thorough, I would check the rest of the line to make sure that there is nothing other than comments or blank characters after the float value */
-	return val;
+	return outFilePath;
 }
@@ -10,8 +10,21 @@
 #define dataFileIO_hpp
 
 #include <string>
+#include <vector>
+#include "Segment.hpp"
 
-void readDataFile(const std::string& filePath, int& paneWidth, int& paneHeight);
-std::string writeDataFile(const std::string& fileRootPath);
+/**	Reads a scene file (text or binary) into the default scene
+ *	@return 0, or the error code (the application's exit code for this error)
+ */
+int readDataFile(const std::string& filePath, int& paneWidth, int& paneHeight);
+
+/**	Saves the default scene in a new data file
+ *	@param fileRootPath	path of the file, without the .txt extension.  A number is added
+ *						to it if there is already a file at that path.
+ *	@param intersections	intersections of the segments to save along, if any
+ *	@return the path of the file written, an empty string if it couldn't be written
+ */
+std::string writeDataFile(const std::string& fileRootPath,
+						  const std::vector<geometry::IntersectionRecord>* intersections = nullptr);
 
 #endif /* dataFileIO_hpp */
@@ -86,6 +86,11 @@ bool snapPoint(void);
  */
 bool snapAll(void);
 
+/**	Saves the scene, with the intersections currently displayed, in a new data file,
+ *	which becomes the file that Ctrl-R restores.
+ */
+void saveScene(void);
+
 void interfaceInit(void);
 void applicationInit(int argc, char* argv[]);
 void zeEnd(void);
@@ -143,9 +148,16 @@ const GLint	EXIT_MENU_ITEM = 0,
 			//
 			SAVE_TO_FILE = 5,
 			RESTORE_FROM_FILE = 6,
+			//
+			FIND_INTERSECTION_GRID = 7,
+			LIVE_INTERSECTIONS = 8,
             //
             SEPARATOR = -1;
 
+//	Position of the live intersections toggle in the main menu
+const int LIVE_INTERSECTIONS_MENU_POS = 10;
+const string LIVE_INTERSECTIONS_MENU_STR = "Live intersections: ";
+
 const GLint	POINT_CREATION_CODE = 10,
 			SEGMENT_CREATION_CODE = 11;
 //			POINT_EDIT_CODE = 20,
@@ -195,7 +207,8 @@ bool snapToSegment = false;
 
 string dataFilePath;
 
-vector <unique_ptr<PointStruct> > intersectionPointList;
+//	Reused from one intersection search to the next
+vector<IntersectionRecord> intersectionPointList;
 
 #if 0
 //-----------------------------------------------------------------
@@ -291,8 +304,11 @@ void displayFunc(void){
 		Segment::renderCreated(firstEndpoint, nextPt);
 	}
 
-	for (size_t k=0; k<intersectionPointList.size(); k++) {
-		Point::render(*(intersectionPointList[k]), PointType::INTERSECTION_POINT);
+	/**	In live mode, the intersections are maintained as segments get created */
+	const vector<IntersectionRecord>& intersections = Segment::getIncrementalIntersections() ?
+														Segment::getLiveIntersections() : intersectionPointList;
+	for (size_t k=0; k<intersections.size(); k++) {
+		Point::render(PointStruct(intersections[k].x, intersections[k].y), PointType::INTERSECTION_POINT);
 	}
 
 	glPopMatrix();
@@ -391,16 +407,29 @@ void menuHandlerFunc(int value){
 			break;
 
 		case FIND_INTERSECTION_BRUTE:
-			intersectionPointList.clear();
-			intersectionPointList = geometry::findAllIntersectionsBruteForce(Segment::getAllSegments());
+			geometry::findAllIntersectionsBruteForce(Segment::getAllSegments(), intersectionPointList);
 			break;
 			
 		case FIND_INTERSECTION_SMART:
-			intersectionPointList.clear();
-			intersectionPointList = geometry::findAllIntersectionsSmart(Segment::getAllSegments());
+			geometry::findAllIntersectionsSmart(Segment::getAllSegments(), intersectionPointList);
+			break;
+
+		case FIND_INTERSECTION_GRID:
+			geometry::findAllIntersectionsGrid(Segment::getAllSegments(), intersectionPointList);
+			break;
+
+		case LIVE_INTERSECTIONS:
+			Segment::setIncrementalIntersections(!Segment::getIncrementalIntersections());
+			{
+				string valStr = Segment::getIncrementalIntersections() ? "on" : "off";
+				glutChangeToMenuEntry(LIVE_INTERSECTIONS_MENU_POS,
+									(LIVE_INTERSECTIONS_MENU_STR+valStr).c_str(),
+									LIVE_INTERSECTIONS);
+			}
 			break;
 
 		case SAVE_TO_FILE:
+			saveScene();
 			break;
 			
 		case RESTORE_FROM_FILE:
@@ -511,7 +540,7 @@ void keyboardHandlerFunc(unsigned char key, int x, int y){
 		case 's':
 		case 'S':
 			if (glutGetModifiers() & GLUT_ACTIVE_CTRL){
-				writeDataFile(rootFilePath);
+				saveScene();
 			}
 			break;
 
@@ -535,6 +564,16 @@ void keyboardHandlerFunc(unsigned char key, int x, int y){
 }
 
 
+void saveScene(void){
+	const vector<IntersectionRecord>& intersections = Segment::getIncrementalIntersections() ?
+														Segment::getLiveIntersections() : intersectionPointList;
+	const string filePath = writeDataFile(rootFilePath, &intersections);
+	if (!filePath.empty()){
+		cout << "Scene saved to " << filePath << endl;
+		dataFilePath = filePath;
+	}
+}
+
 #if 0
 //-----------------------------------------------------------------
 #pragma mark -
@@ -587,6 +626,8 @@ void interfaceInit(void){
 	glutAddMenuEntry("-", SEPARATOR);
 	glutAddMenuEntry("Find All Intersections (brute force)", FIND_INTERSECTION_BRUTE);
 	glutAddMenuEntry("Find All Intersections (smart)", FIND_INTERSECTION_SMART);
+	glutAddMenuEntry("Find All Intersections (grid)", FIND_INTERSECTION_GRID);
+	glutAddMenuEntry((LIVE_INTERSECTIONS_MENU_STR + "off").c_str(), LIVE_INTERSECTIONS);
 	glutAddMenuEntry("-", SEPARATOR);
 	glutAddMenuEntry("Save to File", SAVE_TO_FILE);
 	glutAddMenuEntry("Restore from File", RESTORE_FROM_FILE);
@@ -600,7 +641,10 @@ void applicationInit(int argc, char* argv[]){
 	if (argc == 2){
 		/**	save the path to be able to reload the scene */
 		dataFilePath = argv[1];
-		readDataFile(dataFilePath, PANE_WIDTH, PANE_HEIGHT);
+		const int err = readDataFile(dataFilePath, PANE_WIDTH, PANE_HEIGHT);
+		if (err != 0){
+			exit(err);
+		}
 	}else if (argc > 2){
 		cout << "This program accets only one argument (path to a data file " <<
 				"or none at all." << endl;
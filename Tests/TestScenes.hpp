@@ -0,0 +1,211 @@
+//
+//  TestScenes.hpp
+//
+//	Helpers shared by the tests: the random scenes they run on, and the
+//	comparison of lists of intersections.
+//
+
+#ifndef TestScenes_hpp
+#define TestScenes_hpp
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <tuple>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include "Point.hpp"
+#include "Segment.hpp"
+
+namespace geometry {
+
+	/**	Kinds of random scenes, in a world of side 1000:
+	 *		- UNIFORM: endpoints anywhere in the world
+	 *		- SHORT: segments about as long as the distance between their centers
+	 *		- LONG: segments from a side of the world to another
+	 *		- GRID: horizontal and vertical segments
+	 *		- DEGENERATE: groups of segments that share endpoints, overlap on a common line,
+	 *		  or end on another segment
+	 */
+	enum class TestDistribution{
+		UNIFORM,
+		SHORT,
+		LONG,
+		GRID,
+		DEGENERATE
+	};
+
+	/**	Scenes of a distribution, one per seed of [firstSeed, firstSeed + numSeeds) */
+	struct TestScenes{
+		TestDistribution distribution;
+		size_t numSegments;
+		uint64_t firstSeed;
+		uint64_t numSeeds;
+	};
+
+	struct TestSegment{
+		float x1, y1, x2, y2;
+	};
+
+	inline const char* getDistributionName(TestDistribution distribution){
+		static const char* const NAMES[] = {"uniform", "short", "long", "grid", "degenerate"};
+		return NAMES[static_cast<int>(distribution)];
+	}
+
+	/**	@return groups of 4 segments whose coordinates are multiples of 1/4, so that floats
+	 *	hold them exactly: chains of segments end to end, collinear segments that overlap,
+	 *	stars of segments sharing an endpoint, and segments ending on another one or
+	 *	crossing it at a point of the lattice
+	 */
+	inline std::vector<TestSegment> makeDegenerateScene(size_t numSegments, uint64_t seed){
+		static const int DIRECTIONS[][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}, {2, 1}, {1, 2}, {2, -1}, {1, -2}};
+		//	segments from c + k1 step d + l1 step e to c + k2 step d + l2 step e, per kind of group
+		static const int GROUPS[4][4][4] = {
+			{{0, 0, 1, 0}, {1, 0, 2, 0}, {2, 0, 3, 0}, {3, 0, 4, 0}},		//	chain
+			{{0, 0, 2, 0}, {1, 0, 3, 0}, {2, 0, 4, 0}, {0, 0, 4, 0}},		//	overlaps
+			{{0, 0, 2, 0}, {0, 0, 0, 2}, {0, 0, -2, 0}, {0, 0, 0, -2}},		//	star
+			{{-2, 0, 2, 0}, {0, 0, 0, 2}, {1, -1, 1, 1}, {2, 0, 2, 2}}		//	junctions and a crossing
+		};
+		const double size = 1000.0;
+		std::mt19937_64 rng(seed);
+		const double numGroups = std::ceil(static_cast<double>(numSegments) / 4.0);
+		//	the groups span about 4 steps, the distance between their centers
+		const double step = std::max(std::round(size / std::sqrt(numGroups)), 1.0) * 0.25;
+		std::vector<TestSegment> segments;
+		for (size_t first=0; first<numSegments; first+=4){
+			const double cx = static_cast<double>(rng() % 4000) * 0.25, cy = static_cast<double>(rng() % 4000) * 0.25;
+			const int* d = DIRECTIONS[rng() % 8];
+			const double dx = d[0] * step, dy = d[1] * step, ex = -d[1] * step, ey = d[0] * step;
+			const int (*group)[4] = GROUPS[(first / 4) % 4];
+			for (size_t k=0; k<4 && first+k<numSegments; k++){
+				const int* o = group[k];
+				segments.push_back(TestSegment{static_cast<float>(cx + o[0]*dx + o[1]*ex), static_cast<float>(cy + o[0]*dy + o[1]*ey),
+											   static_cast<float>(cx + o[2]*dx + o[3]*ex), static_cast<float>(cy + o[2]*dy + o[3]*ey)});
+			}
+		}
+		return segments;
+	}
+
+	/**	@return the segments of the scene of a distribution and seed */
+	inline std::vector<TestSegment> makeTestScene(TestDistribution distribution, size_t numSegments, uint64_t seed){
+		if (distribution == TestDistribution::DEGENERATE){
+			return makeDegenerateScene(numSegments, seed);
+		}
+		const double size = 1000.0;
+		std::mt19937_64 rng(seed);
+		auto uniform = [&rng](double max){
+			return max * static_cast<double>(rng() >> 11) * 0x1.0p-53;
+		};
+		std::vector<TestSegment> segments;
+		for (size_t k=0; k<numSegments; k++){
+			double x1, y1, x2, y2;
+			switch (distribution){
+				case TestDistribution::UNIFORM:
+					x1 = uniform(size);		y1 = uniform(size);
+					x2 = uniform(size);		y2 = uniform(size);
+					break;
+				case TestDistribution::SHORT:{
+					const double halfLength = 0.5 * size / std::sqrt(static_cast<double>(numSegments)) * (0.5 + uniform(1.0));
+					const double angle = uniform(M_PI);
+					const double cx = uniform(size), cy = uniform(size);
+					x1 = cx - halfLength * std::cos(angle);		y1 = cy - halfLength * std::sin(angle);
+					x2 = cx + halfLength * std::cos(angle);		y2 = cy + halfLength * std::sin(angle);
+					break;
+				}
+				case TestDistribution::LONG:{
+					//	a point on the bottom, right, top or left side, and one on another side
+					double coords[2][2];
+					const unsigned int side1 = static_cast<unsigned int>(rng() % 4);
+					const unsigned int side2 = (side1 + 1 + static_cast<unsigned int>(rng() % 3)) % 4;
+					for (unsigned int e=0; e<2; e++){
+						const unsigned int side = e == 0 ? side1 : side2;
+						const double t = uniform(size);
+						coords[e][0] = side == 0 || side == 2 ? t : (side == 1 ? size : 0.0);
+						coords[e][1] = side == 1 || side == 3 ? t : (side == 2 ? size : 0.0);
+					}
+					x1 = coords[0][0];		y1 = coords[0][1];
+					x2 = coords[1][0];		y2 = coords[1][1];
+					break;
+				}
+				default:{	//	GRID
+					const double line = size * (static_cast<double>(k / 2) + 0.5) / static_cast<double>((numSegments + 1) / 2);
+					const double from = uniform(size), to = uniform(size);
+					if (k % 2 == 0){
+						x1 = from;		y1 = line;		x2 = to;		y2 = line;
+					}else{
+						x1 = line;		y1 = from;		x2 = line;		y2 = to;
+					}
+					break;
+				}
+			}
+			segments.push_back(TestSegment{static_cast<float>(x1), static_cast<float>(y1),
+										   static_cast<float>(x2), static_cast<float>(y2)});
+		}
+		return segments;
+	}
+
+	/**	Replaces all the points and segments by those of a scene
+	 *	@return the segments, in the order of their indices
+	 */
+	inline const std::vector<std::shared_ptr<Segment> >& loadTestScene(const std::vector<TestSegment>& segments){
+		Segment::clearAllSegments();
+		Point::clearAllPoints();
+		for (const TestSegment& seg : segments){
+			Segment::makeNewSegPtr(Point::makeNewPointPtr(seg.x1, seg.y1), Point::makeNewPointPtr(seg.x2, seg.y2));
+		}
+		return Segment::getAllSegments();
+	}
+
+	inline bool isRecordBefore(const IntersectionRecord& a, const IntersectionRecord& b){
+		return std::tie(a.segA, a.segB, a.x, a.y) < std::tie(b.segA, b.segB, b.x, b.y);
+	}
+
+	inline bool isSameRecord(const IntersectionRecord& a, const IntersectionRecord& b){
+		return a.segA == b.segA && a.segB == b.segB && a.x == b.x && a.y == b.y;
+	}
+
+	/**	@return true if the lists hold the same records in the same order */
+	inline bool isSameList(const std::vector<IntersectionRecord>& expected, const std::vector<IntersectionRecord>& found){
+		return expected.size() == found.size() && std::equal(expected.begin(), expected.end(), found.begin(), isSameRecord);
+	}
+
+	/**	@return the number of records of one list that are not in the other (with the same
+	 *	point, bit for bit), whatever the order of the lists
+	 */
+	inline size_t countDifferences(std::vector<IntersectionRecord> expected, std::vector<IntersectionRecord> found){
+		std::sort(expected.begin(), expected.end(), isRecordBefore);
+		std::sort(found.begin(), found.end(), isRecordBefore);
+		size_t numDifferences = 0;
+		auto e = expected.begin();
+		auto f = found.begin();
+		while (e != expected.end() || f != found.end()){
+			if (f == found.end() || (e != expected.end() && isRecordBefore(*e, *f))){
+				numDifferences++;
+				++e;
+			}else if (e == expected.end() || isRecordBefore(*f, *e)){
+				numDifferences++;
+				++f;
+			}else{
+				++e;
+				++f;
+			}
+		}
+		return numDifferences;
+	}
+
+	/**	Counts a failed check, printing what failed
+	 *	@return	condition
+	 */
+	inline bool check(bool condition, const std::string& what, size_t& numFailed){
+		if (!condition){
+			std::cout << "FAILED: " << what << std::endl;
+			numFailed++;
+		}
+		return condition;
+	}
+}
+
+#endif /* TestScenes_hpp */
@@ -0,0 +1,80 @@
+//
+//  countersTest.cpp
+//
+//	Checks the counters of Counters.hpp: without GEOMETRY_COUNTERS they stay at zero;
+//	with it, the searches and registries count their work, the threads of the parallel
+//	search are summed after they ended, and resetCounters starts over.
+//	Returns 0 if all the checks passed.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Scene.hpp"
+#include "Segment.hpp"
+#include "Counters.hpp"
+#include "TestScenes.hpp"
+
+using namespace std;
+using namespace geometry;
+
+static bool areAllZero_(const CounterValues& counters){
+	for (uint64_t value : counters.values){
+		if (value != 0){
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(void){
+	size_t numFailed = 0;
+	const vector<TestSegment> segments = makeTestScene(TestDistribution::SHORT, 2000, 1);
+
+	resetCounters();
+	Scene scene;
+	for (const TestSegment& seg : segments){
+		scene.makeNewSegId(scene.makeNewPointId(seg.x1, seg.y1), scene.makeNewPointId(seg.x2, seg.y2));
+	}
+	const CounterValues registry = getCounters();
+
+	resetCounters();
+	vector<IntersectionRecord> found;
+	findAllIntersectionsBruteForce(scene.getAllSegments(), found);
+	const CounterValues bruteForce = getCounters();
+
+	resetCounters();
+	vector<IntersectionRecord> parallelFound;
+	findAllIntersectionsBruteForceParallel(scene.getAllSegments(), parallelFound, 4);
+	const CounterValues parallel = getCounters();
+
+	resetCounters();
+	vector<IntersectionRecord> sweepFound;
+	findAllIntersectionsSmart(scene.getAllSegments(), sweepFound);
+	const CounterValues sweep = getCounters();
+
+	if (!COUNTERS_ENABLED){
+		check(areAllZero_(registry) && areAllZero_(bruteForce) && areAllZero_(parallel) && areAllZero_(sweep),
+			  "no counts without GEOMETRY_COUNTERS", numFailed);
+		return numFailed == 0 ? 0 : 1;
+	}
+
+	check(registry[Counter::SEGMENT_REGISTRY_PROBES] >= segments.size() &&
+		  registry[Counter::POINT_REGISTRY_PROBES] > 0, "registry probes", numFailed);
+	check(!found.empty() && bruteForce[Counter::SEGMENT_PAIR_TESTS] >= found.size() &&
+		  bruteForce[Counter::INTERSECTION_POINTS] >= found.size() &&
+		  bruteForce[Counter::ORIENTATION_TESTS] >= 4 * found.size() &&
+		  bruteForce[Counter::ORIENTATION_TESTS] >= bruteForce[Counter::EXACT_ORIENTATION_TESTS] &&
+		  bruteForce[Counter::SWEEP_QUEUE_POPS] == 0, "counts of the brute force", numFailed);
+	check(parallel[Counter::SEGMENT_PAIR_TESTS] == bruteForce[Counter::SEGMENT_PAIR_TESTS] &&
+		  parallel[Counter::ORIENTATION_TESTS] == bruteForce[Counter::ORIENTATION_TESTS],
+		  "the threads of the parallel brute force are summed", numFailed);
+	check(sweep[Counter::SWEEP_QUEUE_INSERTS] >= 2 * scene.getAllSegments().size() &&
+		  sweep[Counter::SWEEP_QUEUE_POPS] <= sweep[Counter::SWEEP_QUEUE_INSERTS] &&
+		  sweep[Counter::SWEEP_QUEUE_POPS] >= 2 * scene.getAllSegments().size() &&
+		  sweep[Counter::SWEEP_STATUS_COMPARISONS] > 0, "counts of the sweep", numFailed);
+
+	resetCounters();
+	check(areAllZero_(getCounters()), "resetCounters", numFailed);
+	return numFailed == 0 ? 0 : 1;
+}
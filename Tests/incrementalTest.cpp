@@ -0,0 +1,73 @@
+//
+//  incrementalTest.cpp
+//
+//	Compares the intersections maintained incrementally (setIncrementalIntersections)
+//	with a full search by findAllIntersectionsGrid, while the segments are added one
+//	by one or in bulk, when the mode is turned on over existing segments, and after a
+//	point moved.
+//	Returns 0 if the live intersections always matched the full search.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include "Segment.hpp"
+#include "Scene.hpp"
+#include "SceneFile.hpp"
+#include "TestScenes.hpp"
+
+using namespace std;
+using namespace geometry;
+
+static const TestScenes TEST_SCENES[] = {
+	{TestDistribution::UNIFORM, 2000, 1, 2},
+	{TestDistribution::SHORT, 2000, 1, 2},
+	{TestDistribution::LONG, 2000, 1, 2}
+};
+
+/**	Checks the live intersections against a full search of all the segments */
+static void checkLive_(const string& name, size_t& numFailed){
+	vector<IntersectionRecord> expected;
+	findAllIntersectionsGrid(Segment::getAllSegments(), expected);
+	check(countDifferences(expected, Segment::getLiveIntersections()) == 0, name, numFailed);
+}
+
+int main(void){
+	size_t numFailed = 0;
+	Segment::setIndexCellSize(1000.f / 64.f);
+	for (const TestScenes& test : TEST_SCENES){
+		for (uint64_t seed=test.firstSeed; seed<test.firstSeed+test.numSeeds; seed++){
+			const string name = string(getDistributionName(test.distribution)) + " " + to_string(test.numSegments)
+								+ " seed " + to_string(seed);
+			const vector<TestSegment> scene = makeTestScene(test.distribution, test.numSegments, seed);
+
+			//	segments added one by one, half of them before a point moves
+			Segment::setIncrementalIntersections(true);
+			Segment::clearAllSegments();
+			Point::clearAllPoints();
+			for (size_t k=0; k<scene.size(); k++){
+				const TestSegment& seg = scene[k];
+				Segment::makeNewSegPtr(Point::makeNewPointPtr(seg.x1, seg.y1), Point::makeNewPointPtr(seg.x2, seg.y2));
+				if (k == scene.size() / 2){
+					checkLive_(name + ": half of the segments added", numFailed);
+					Segment::getAllSegments()[0]->getP1()->setCoordinates(500.f, 500.f);
+					checkLive_(name + ": after a point moved", numFailed);
+				}
+			}
+			checkLive_(name + ": all the segments added", numFailed);
+			Segment::getAllSegments().back()->getP2()->setCoordinates(250.f, 750.f);
+			checkLive_(name + ": after the last point moved", numFailed);
+
+			//	mode turned on over existing segments
+			Segment::setIncrementalIntersections(false);
+			check(Segment::getLiveIntersections().empty(), name + ": no live intersections when off", numFailed);
+			loadTestScene(scene);
+			Segment::setIncrementalIntersections(true);
+			checkLive_(name + ": turned on after loading", numFailed);
+			check(!Segment::getLiveIntersections().empty(), name + ": the scene has intersections", numFailed);
+			Segment::setIncrementalIntersections(false);
+		}
+	}
+	return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+//
+//  kernelTest.cpp
+//
+//	Compares intersectsBatch with the scalar Segment::intersects, for every number
+//	of segments tested (so that the masking of the tail lanes is checked too), on
+//	random scenes and on scenes of small integer coordinates, where segments share
+//	endpoints, touch, or are collinear.
+//	Returns 0 if the kernel agreed with the scalar test everywhere.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include "Segment.hpp"
+#include "OrientationKernel.hpp"
+#include "TestScenes.hpp"
+
+using namespace std;
+using namespace geometry;
+
+/**	@return segments whose endpoints are on a grid of 5 x 5 integer points */
+static vector<TestSegment> makeIntegerScene_(size_t numSegments, uint64_t seed){
+	mt19937_64 rng(seed);
+	vector<TestSegment> segments;
+	while (segments.size() < numSegments){
+		const TestSegment seg{static_cast<float>(rng() % 5), static_cast<float>(rng() % 5),
+							  static_cast<float>(rng() % 5), static_cast<float>(rng() % 5)};
+		if (seg.x1 != seg.x2 || seg.y1 != seg.y2){
+			segments.push_back(seg);
+		}
+	}
+	return segments;
+}
+
+/**	Tests every segment of the scene against every run of at most ORIENTATION_BATCH_SIZE
+ *	segments.  The coordinate arrays are padded with copies of the first segments rather
+ *	than zeros, so that lanes past the count would often report an intersection if they
+ *	were not masked.
+ */
+static void checkScene_(const vector<TestSegment>& scene, const string& name, size_t& numFailed){
+	const vector<shared_ptr<Segment> >& segments = loadTestScene(scene);
+	const size_t numSegs = segments.size();
+	vector<float> x1, y1, x2, y2;
+	for (size_t k=0; k<numSegs+ORIENTATION_BATCH_SIZE; k++){
+		const Segment& seg = *segments[k % numSegs];
+		x1.push_back(seg.getP1()->getX());
+		y1.push_back(seg.getP1()->getY());
+		x2.push_back(seg.getP2()->getX());
+		y2.push_back(seg.getP2()->getY());
+	}
+	size_t numMismatches = 0;
+	for (const shared_ptr<Segment>& segA : segments){
+		const float ax1 = segA->getP1()->getX(), ay1 = segA->getP1()->getY();
+		const float ax2 = segA->getP2()->getX(), ay2 = segA->getP2()->getY();
+		for (size_t first=0; first<numSegs; first++){
+			for (size_t count=0; count<=ORIENTATION_BATCH_SIZE && first+count<=numSegs; count++){
+				uint32_t expected = 0;
+				for (size_t k=0; k<count; k++){
+					if (segA->intersects(*segments[first+k])){
+						expected |= 1u << k;
+					}
+				}
+				const uint32_t found = intersectsBatch(ax1, ay1, ax2, ay2,
+													   &x1[first], &y1[first], &x2[first], &y2[first], count);
+				if (found != expected){
+					numMismatches++;
+				}
+			}
+		}
+	}
+	check(numMismatches == 0, name + ": " + to_string(numMismatches) + " batches differ from the scalar test", numFailed);
+}
+
+int main(void){
+	cout << "kernel: " << orientationKernelName() << endl;
+	size_t numFailed = 0;
+	for (uint64_t seed=1; seed<=3; seed++){
+		checkScene_(makeIntegerScene_(60, seed), "integer 60 seed " + to_string(seed), numFailed);
+		checkScene_(makeTestScene(TestDistribution::UNIFORM, 60, seed), "uniform 60 seed " + to_string(seed), numFailed);
+		checkScene_(makeTestScene(TestDistribution::GRID, 60, seed), "grid 60 seed " + to_string(seed), numFailed);
+	}
+	return numFailed == 0 ? 0 : 1;
+}
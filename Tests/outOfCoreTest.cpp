@@ -0,0 +1,124 @@
+//
+//  outOfCoreTest.cpp
+//
+//	Compares the out-of-core search of scene files, text and binary, in one strip and in
+//	many, with the grid search of the scenes loaded from the same files.  The files list
+//	some points and segments twice, which loading merges.
+//	Returns 0 if the out-of-core search found the intersections of the scenes.
+//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include "Scene.hpp"
+#include "Segment.hpp"
+#include "SceneFile.hpp"
+#include "OutOfCore.hpp"
+#include "TestScenes.hpp"
+
+using namespace std;
+using namespace geometry;
+
+/**	Reads the intersection list written by findAllIntersectionsOutOfCore
+ *	@return false if a line could not be read
+ */
+static bool readIntersections_(const filesystem::path& path, vector<IntersectionRecord>& intersections){
+	ifstream in(path);
+	string line;
+	while (getline(in, line)){
+		if (line.empty() || line[0] == '#'){
+			continue;
+		}
+		char tag;
+		IntersectionRecord inter;
+		istringstream fields(line);
+		if (!(fields >> tag >> inter.x >> inter.y >> inter.segA >> inter.segB) || tag != 'i'){
+			return false;
+		}
+		intersections.push_back(inter);
+	}
+	return true;
+}
+
+/**	@return the scene file data of a generated scene, each segment with its own two points */
+static SceneFileData makeSceneData_(const vector<TestSegment>& segments){
+	SceneFileData data;
+	data.xmax = 1000.f;
+	data.ymax = 1000.f;
+	for (const TestSegment& seg : segments){
+		const unsigned int first = static_cast<unsigned int>(data.points.size());
+		data.points.emplace_back(seg.x1, seg.y1);
+		data.points.emplace_back(seg.x2, seg.y2);
+		data.segments.emplace_back(first, first + 1);
+	}
+	return data;
+}
+
+int main(void){
+	size_t numFailed = 0;
+	const filesystem::path dir = filesystem::temp_directory_path();
+	const filesystem::path textPath = dir / "outOfCoreTest.txt";
+	const filesystem::path binaryPath = dir / "outOfCoreTest.bin";
+	const filesystem::path outPath = dir / "outOfCoreTest.out";
+	SceneFileError error;
+
+	for (TestDistribution distribution : {TestDistribution::UNIFORM, TestDistribution::SHORT, TestDistribution::LONG,
+										  TestDistribution::GRID, TestDistribution::DEGENERATE}){
+		SceneFileData data = makeSceneData_(makeTestScene(distribution, 1000, 1));
+		//	segments listed again, in the other direction, and through copies of their points
+		const size_t numSegments = data.segments.size();
+		for (size_t k=0; k<numSegments; k+=7){
+			const pair<unsigned int, unsigned int> seg = data.segments[k];
+			data.segments.emplace_back(seg.second, seg.first);
+			data.points.push_back(data.points[seg.first]);
+			data.points.push_back(data.points[seg.second]);
+			data.segments.emplace_back(static_cast<unsigned int>(data.points.size() - 2),
+									   static_cast<unsigned int>(data.points.size() - 1));
+		}
+		check(writeSceneFile(textPath.string(), data, error) == SceneFileStatus::OK &&
+			  writeBinarySceneFile(binaryPath.string(), data, error) == SceneFileStatus::OK,
+			  "write the scene files", numFailed);
+
+		//	the scene, and the index in the scene of each segment of the file
+		Scene scene;
+		vector<PointId> pointIds;
+		scene.makeNewPointIds(data.points, pointIds);
+		vector<unsigned int> sceneIndex;
+		for (const pair<unsigned int, unsigned int>& seg : data.segments){
+			sceneIndex.push_back(scene.makeNewSegId(pointIds[seg.first], pointIds[seg.second]).idx);
+		}
+		vector<IntersectionRecord> expected;
+		findAllIntersectionsGrid(scene.getAllSegments(), expected);
+
+		for (const filesystem::path& path : {textPath, binaryPath}){
+			//	the default budget holds the whole scene, the small one splits it in many strips
+			for (size_t memoryBudget : {size_t(256) << 20, size_t(16) << 10}){
+				const string name = string(getDistributionName(distribution)) + " " + path.filename().string() +
+									", budget of " + to_string(memoryBudget) + " bytes";
+				OutOfCoreSettings settings;
+				settings.memoryBudget = memoryBudget;
+				OutOfCoreStats stats;
+				vector<IntersectionRecord> found;
+				if (!check(findAllIntersectionsOutOfCore(path.string(), outPath.string(), settings, error, &stats) == SceneFileStatus::OK &&
+						   readIntersections_(outPath, found), name + ": search", numFailed)){
+					continue;
+				}
+				for (IntersectionRecord& inter : found){
+					inter.segA = sceneIndex[inter.segA];
+					inter.segB = sceneIndex[inter.segB];
+				}
+				check(countDifferences(expected, found) == 0, name + ": intersections", numFailed);
+				check(stats.numIntersections == found.size() && stats.numSegments == data.segments.size() &&
+					  (memoryBudget > (size_t(1) << 20) || stats.numStrips > 1), name + ": statistics", numFailed);
+			}
+		}
+	}
+
+	for (const filesystem::path& path : {textPath, binaryPath, outPath}){
+		filesystem::remove(path);
+	}
+	return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+//
+//  predicatesTest.cpp
+//
+//	Checks the sign of orientation on inputs whose exact sign is known: points
+//	on a diagonal line and points moved off it by one ulp, endpoints shared with
+//	the segment, and points collinear with it.  The float determinant
+//	(orientationDetFloat) is run on the same inputs, for comparison.
+//	Returns 0 if orientation always returned the exact sign.
+//
+
+#include <iostream>
+#include <string>
+#include <random>
+#include <cmath>
+#include "Predicates.hpp"
+#include "TestScenes.hpp"
+
+using namespace std;
+using namespace geometry;
+
+static int floatSign_(float det){
+	return static_cast<int>(det > 0.f) - static_cast<int>(det < 0.f);
+}
+
+int main(void){
+	size_t numFailed = 0;
+	size_t numWrong = 0, numFloatWrong = 0, numTests = 0;
+	auto test = [&](float p1x, float p1y, float p2x, float p2y, float ptx, float pty, int expected){
+		numTests++;
+		if (orientation(p1x, p1y, p2x, p2y, ptx, pty) != expected ||
+			orientationExact(p1x, p1y, p2x, p2y, ptx, pty) != expected){
+			numWrong++;
+		}
+		if (floatSign_(orientationDetFloat(p1x, p1y, p2x, p2y, ptx, pty)) != expected){
+			numFloatWrong++;
+		}
+	};
+
+	mt19937_64 rng(1);
+	uniform_real_distribution<float> coord(-1000.f, 1000.f);
+	for (int k=0; k<100000; k++){
+		//	On the diagonal, det(p2 - p1, pt - p1) = (b - a)(ptx - pty) exactly: its sign is
+		//	known whatever the rounding of the differences.
+		const float a = coord(rng), b = coord(rng), c = coord(rng);
+		const int direction = b > a ? 1 : (b < a ? -1 : 0);
+		test(a, a, b, b, c, c, 0);
+		test(a, a, b, b, c, nextafterf(c, HUGE_VALF), -direction);
+		test(a, a, b, b, c, nextafterf(c, -HUGE_VALF), direction);
+		test(a, a, b, b, nextafterf(c, HUGE_VALF), c, direction);
+
+		//	endpoints shared with the segment
+		const float x1 = coord(rng), y1 = coord(rng), x2 = coord(rng), y2 = coord(rng);
+		test(x1, y1, x2, y2, x1, y1, 0);
+		test(x1, y1, x2, y2, x2, y2, 0);
+
+		//	collinear points: p1 + t(p2 - p1) for small integers t, exact if the
+		//	coordinates are multiples of a power of two in a narrow range
+		const float ux = static_cast<float>(rng() % 4096) * 0.25f, uy = static_cast<float>(rng() % 4096) * 0.25f;
+		const float vx = static_cast<float>(rng() % 64) - 32.f, vy = static_cast<float>(rng() % 64) - 32.f;
+		const float t = static_cast<float>(rng() % 8) - 4.f;
+		test(ux, uy, ux + vx, uy + vy, ux + t*vx, uy + t*vy, 0);
+	}
+	check(numWrong == 0, "orientation: " + to_string(numWrong) + " wrong signs out of " + to_string(numTests), numFailed);
+	cout << "orientationDetFloat: " << numFloatWrong << " wrong signs out of " << numTests << endl;
+	return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+//
+//  registryTest.cpp
+//
+//	Adds the segments of random scenes to a scene one by one, and from several threads
+//	through a ConcurrentRegistry, and checks that both scenes hold the same points and
+//	segments: a point is only merged with a point of exactly the same coordinates, and a
+//	segment with a segment of the same endpoints.  Also checks that the lists of segments
+//	of the points stay sorted, and that the live intersections follow a commit.
+//	Returns 0 if all the checks passed.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <thread>
+#include <tuple>
+#include <cmath>
+#include "Scene.hpp"
+#include "Segment.hpp"
+#include "ConcurrentRegistry.hpp"
+#include "TestScenes.hpp"
+
+using namespace std;
+using namespace geometry;
+
+typedef tuple<float, float, float, float> SegmentKey_;
+
+/**	@return the endpoints of the segments of a scene, each with its endpoints in a canonical order */
+static set<SegmentKey_> segmentKeys_(const Scene& scene){
+	set<SegmentKey_> keys;
+	for (const shared_ptr<Segment>& seg : scene.getAllSegments()){
+		const pair<float, float> p1(seg->getP1()->getX(), seg->getP1()->getY());
+		const pair<float, float> p2(seg->getP2()->getX(), seg->getP2()->getY());
+		const pair<float, float>& first = min(p1, p2);
+		const pair<float, float>& second = max(p1, p2);
+		keys.emplace(first.first, first.second, second.first, second.second);
+	}
+	return keys;
+}
+
+static set<pair<float, float> > pointKeys_(const Scene& scene){
+	set<pair<float, float> > keys;
+	for (const shared_ptr<Point>& pt : scene.getAllPoints()){
+		keys.emplace(pt->getX(), pt->getY());
+	}
+	return keys;
+}
+
+/**	@return true if the scenes have the same points and segments, without duplicates */
+static bool isSameScene_(const Scene& a, const Scene& b){
+	const set<pair<float, float> > points = pointKeys_(a);
+	const set<SegmentKey_> segments = segmentKeys_(a);
+	return points.size() == a.getAllPoints().size() && segments.size() == a.getAllSegments().size() &&
+		   b.getAllPoints().size() == a.getAllPoints().size() && b.getAllSegments().size() == a.getAllSegments().size() &&
+		   pointKeys_(b) == points && segmentKeys_(b) == segments;
+}
+
+/**	@return true if the segments of each point are listed in increasing order of index */
+static bool areSegListsSorted_(const Scene& scene){
+	for (const shared_ptr<Point>& pt : scene.getAllPoints()){
+		const span<const unsigned int> segList = pt->getSegList();
+		if (!is_sorted(segList.begin(), segList.end())){
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(void){
+	size_t numFailed = 0;
+	for (TestDistribution distribution : {TestDistribution::SHORT, TestDistribution::GRID, TestDistribution::DEGENERATE}){
+		const string name = getDistributionName(distribution);
+		vector<TestSegment> segments = makeTestScene(distribution, 5000, 1);
+
+		/**	Points one float step away from others, which must not be merged with them, and
+		 *	segments added twice, in both directions, which must be
+		 */
+		const size_t numSegments = segments.size();
+		for (size_t k=0; k<numSegments; k+=10){
+			const TestSegment seg = segments[k];
+			segments.push_back(TestSegment{nextafterf(seg.x1, HUGE_VALF), seg.y1, seg.x2, seg.y2});
+			segments.push_back(TestSegment{seg.x2, seg.y2, seg.x1, seg.y1});
+		}
+		set<pair<float, float> > distinctPoints;
+		for (const TestSegment& seg : segments){
+			distinctPoints.emplace(seg.x1, seg.y1);
+			distinctPoints.emplace(seg.x2, seg.y2);
+		}
+
+		Scene serial;
+		for (const TestSegment& seg : segments){
+			serial.makeNewSegId(serial.makeNewPointId(seg.x1, seg.y1), serial.makeNewPointId(seg.x2, seg.y2));
+		}
+		check(pointKeys_(serial) == distinctPoints && serial.getAllPoints().size() == distinctPoints.size(),
+			  name + ": only the points of the same coordinates are merged", numFailed);
+
+		//	half of the segments committed first, so that the other half also finds points of the scene
+		Scene concurrent;
+		concurrent.setIncrementalIntersections(true);
+		{
+			const unsigned int numThreads = 8;
+			ConcurrentRegistry registry(concurrent);
+			for (size_t half=0; half<2; half++){
+				const size_t first = half * segments.size() / 2, last = (half + 1) * segments.size() / 2;
+				vector<thread> threads;
+				for (unsigned int t=0; t<numThreads; t++){
+					threads.emplace_back([&, t]{
+						for (size_t k=first+(last-first)*t/numThreads; k<first+(last-first)*(t+1)/numThreads; k++){
+							const TestSegment& seg = segments[k];
+							registry.makeNewSegId(registry.makeNewPointId(seg.x1, seg.y1),
+												  registry.makeNewPointId(seg.x2, seg.y2));
+						}
+					});
+				}
+				for (thread& th : threads){
+					th.join();
+				}
+				registry.commit();
+			}
+		}
+		check(isSameScene_(serial, concurrent), name + ": concurrent insertion", numFailed);
+		check(areSegListsSorted_(concurrent), name + ": lists of segments of the points sorted", numFailed);
+		vector<IntersectionRecord> expected;
+		findAllIntersectionsGrid(concurrent.getAllSegments(), expected);
+		check(countDifferences(expected, concurrent.getLiveIntersections()) == 0,
+			  name + ": live intersections after commit", numFailed);
+	}
+	return numFailed == 0 ? 0 : 1;
+}
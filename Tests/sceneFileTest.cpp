@@ -0,0 +1,264 @@
+//
+//  sceneFileTest.cpp
+//
+//	Parses scene files written by hand (comments, blank lines, tabs, Windows line
+//	ends, errors) and files written from generated scenes, read back through the
+//	memory-mapped reader, streamed, and added to a scene in bulk.  The files are
+//	written back, with their intersections, and converted to the binary format
+//	and back: text -> binary -> text gives the same file.  A large text is parsed
+//	in parallel, with the same data (or error) as the sequential parse.
+//	Returns 0 if all the readings gave back the scenes written.
+//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <algorithm>
+#include "Scene.hpp"
+#include "Segment.hpp"
+#include "SceneFile.hpp"
+#include "TestScenes.hpp"
+
+using namespace std;
+using namespace geometry;
+
+/**	Handler of streamSceneFile that stores the records in a SceneFileData
+ */
+class CopyHandler_ : public SceneFileHandler{
+
+	private:
+
+		SceneFileData& data_;
+
+	public:
+
+		explicit CopyHandler_(SceneFileData& data) : data_(data){
+		}
+
+		void setWorldBounds(float xmin, float xmax, float ymin, float ymax) override{
+			data_.xmin = xmin;
+			data_.xmax = xmax;
+			data_.ymin = ymin;
+			data_.ymax = ymax;
+		}
+
+		void addPoint(float x, float y) override{
+			data_.points.emplace_back(x, y);
+		}
+
+		void addSegment(unsigned int index1, unsigned int index2) override{
+			data_.segments.emplace_back(index1, index2);
+		}
+
+		void addIntersection(const IntersectionRecord& inter) override{
+			data_.intersections.push_back(inter);
+		}
+};
+
+/**	@return true if the scenes have the same bounds, points (bit for bit), segments and intersections */
+static bool isSameScene_(const SceneFileData& a, const SceneFileData& b){
+	if (a.xmin != b.xmin || a.xmax != b.xmax || a.ymin != b.ymin || a.ymax != b.ymax ||
+		a.points.size() != b.points.size() || a.segments != b.segments){
+		return false;
+	}
+	for (size_t k=0; k<a.points.size(); k++){
+		if (a.points[k].x != b.points[k].x || a.points[k].y != b.points[k].y){
+			return false;
+		}
+	}
+	return isSameList(a.intersections, b.intersections);
+}
+
+/**	@return the text of a scene file holding the segments, each with its own two points */
+static string makeText_(const vector<TestSegment>& segments){
+	ostringstream text;
+	text.precision(9);
+	text << "XMIN = 0\nXMAX = 1000\nYMIN = 0\nYMAX = 1000\n";
+	for (const TestSegment& seg : segments){
+		text << "p " << seg.x1 << " " << seg.y1 << "\np " << seg.x2 << " " << seg.y2 << "\n";
+	}
+	for (size_t k=0; k<segments.size(); k++){
+		text << "s " << 2*k << " " << 2*k+1 << "\n";
+	}
+	return text.str();
+}
+
+static string readText_(const filesystem::path& path){
+	ifstream in(path, ios::binary);
+	ostringstream text;
+	text << in.rdbuf();
+	return text.str();
+}
+
+/**	@return true if the scenes have the same points and segments, in the same order */
+static bool isSameScene_(const Scene& a, const Scene& b){
+	bool same = a.getAllPoints().size() == b.getAllPoints().size() &&
+				a.getAllSegments().size() == b.getAllSegments().size();
+	for (size_t k=0; same && k<a.getAllSegments().size(); k++){
+		const Segment& segA = *a.getAllSegments()[k];
+		const Segment& segB = *b.getAllSegments()[k];
+		same = segA.getP1()->getX() == segB.getP1()->getX() && segA.getP1()->getY() == segB.getP1()->getY() &&
+			   segA.getP2()->getX() == segB.getP2()->getX() && segA.getP2()->getY() == segB.getP2()->getY();
+	}
+	return same;
+}
+
+int main(void){
+	size_t numFailed = 0;
+	SceneFileError error;
+
+	//	A file written by hand
+	const string handwritten =
+		"# a scene\r\n"
+		"XMIN = 0\r\n"
+		"XMAX = 10 (ignored)\r\n"
+		"\r\n"
+		"  YMIN\t=\t-10\r\n"
+		"YMAX = +10\r\n"
+		"p 0 0\r\n"
+		"   # a comment between points\r\n"
+		"v\t10 0\r\n"
+		"p 5 5\r\n"
+		"p 5 -5\r\n"
+		"s 0 1\r\n"
+		"\t\r\n"
+		"s 2 3";
+	SceneFileData data;
+	check(parseSceneFile(handwritten, data, error) == SceneFileStatus::OK &&
+		  data.xmin == 0.f && data.xmax == 10.f && data.ymin == -10.f && data.ymax == 10.f &&
+		  data.points.size() == 4 && data.points[1].x == 10.f && data.points[3].y == -5.f &&
+		  data.segments == vector<pair<unsigned int, unsigned int> >{{0, 1}, {2, 3}},
+		  "handwritten file", numFailed);
+
+	//	Errors, with the number of the line at fault
+	const string bounds = "XMIN = 0\nXMAX = 10\nYMIN = 0\nYMAX = 10\n";
+	const pair<string, size_t> badRecords[] = {
+		{bounds + "p 0 0\np 1 1\ns 0 2\n", 7},
+		{bounds + "p 0 0\np 1 x\ns 0 1\n", 6},
+		{bounds + "p 0 0\np 1 1\n\ns 0\n", 8}
+	};
+	for (const pair<string, size_t>& bad : badRecords){
+		data = SceneFileData();
+		error = SceneFileError();
+		check(parseSceneFile(bad.first, data, error) == SceneFileStatus::INVALID_RECORD &&
+			  error.status == SceneFileStatus::INVALID_RECORD && error.lineNumber == bad.second,
+			  "invalid record at line " + to_string(bad.second), numFailed);
+	}
+	data = SceneFileData();
+	error = SceneFileError();
+	check(parseSceneFile("XMIN = 0\nXMAX = 10\nYMAX = 10\n", data, error) == SceneFileStatus::INVALID_WORLD_BOUND &&
+		  error.lineNumber == 3, "invalid world bound", numFailed);
+
+	//	Generated scenes, through a file
+	const filesystem::path dir = filesystem::temp_directory_path();
+	const filesystem::path path = dir / "sceneFileTest.txt";
+	const filesystem::path binaryPath = dir / "sceneFileTest.bin";
+	const filesystem::path path2 = dir / "sceneFileTest2.txt";
+	check(readSceneFile((path.parent_path() / "sceneFileTest.none").string(), data, error) ==
+		  SceneFileStatus::FILE_NOT_FOUND, "missing file", numFailed);
+	for (TestDistribution distribution : {TestDistribution::UNIFORM, TestDistribution::SHORT, TestDistribution::DEGENERATE}){
+		const string name = getDistributionName(distribution);
+		const vector<TestSegment> segments = makeTestScene(distribution, 2000, 1);
+		const string text = makeText_(segments);
+		{
+			ofstream out(path, ios::binary);
+			out << text;
+		}
+		SceneFileData parsed, read;
+		check(parseSceneFile(text, parsed, error) == SceneFileStatus::OK &&
+			  readSceneFile(path.string(), read, error) == SceneFileStatus::OK && isSameScene_(parsed, read),
+			  name + ": memory-mapped reading", numFailed);
+		bool samePoints = parsed.points.size() == 2*segments.size();
+		for (size_t k=0; samePoints && k<segments.size(); k++){
+			samePoints = parsed.points[2*k].x == segments[k].x1 && parsed.points[2*k].y == segments[k].y1 &&
+						 parsed.points[2*k+1].x == segments[k].x2 && parsed.points[2*k+1].y == segments[k].y2;
+		}
+		check(samePoints, name + ": coordinates read back exactly", numFailed);
+
+		//	added in bulk, the points and segments are merged as when added one by one
+		Scene serial, bulk;
+		for (const TestSegment& seg : segments){
+			serial.makeNewSegId(serial.makeNewPointId(seg.x1, seg.y1), serial.makeNewPointId(seg.x2, seg.y2));
+		}
+		addToScene(read, bulk);
+		check(isSameScene_(serial, bulk), name + ": addToScene", numFailed);
+
+		//	the text written back with the intersections, then without them, through the binary format
+		SceneFileData withIntersections = parsed;
+		findAllIntersectionsGrid(bulk.getAllSegments(), withIntersections.intersections);
+		check(writeSceneFile(path.string(), withIntersections, error) == SceneFileStatus::OK,
+			  name + ": write text with intersections", numFailed);
+		read = SceneFileData();
+		check(readSceneFile(path.string(), read, error) == SceneFileStatus::OK && isSameScene_(withIntersections, read),
+			  name + ": text written back with intersections", numFailed);
+		read = SceneFileData();
+		CopyHandler_ handler(read);
+		check(streamSceneFile(path.string(), handler, error) == SceneFileStatus::OK && isSameScene_(withIntersections, read),
+			  name + ": streamed text", numFailed);
+		check(writeSceneFile(path.string(), parsed, error) == SceneFileStatus::OK, name + ": write text", numFailed);
+		read = SceneFileData();
+		check(readSceneFile(path.string(), read, error) == SceneFileStatus::OK && isSameScene_(parsed, read),
+			  name + ": text written back", numFailed);
+		check(convertSceneFile(path.string(), binaryPath.string(), error) == SceneFileStatus::OK &&
+			  isBinarySceneFile(binaryPath.string()) && !isBinarySceneFile(path.string()),
+			  name + ": text to binary", numFailed);
+		BinarySceneFile binary;
+		if (check(binary.open(binaryPath.string(), error) == SceneFileStatus::OK, name + ": open binary", numFailed)){
+			read = SceneFileData();
+			binary.copyTo(read);
+			check(isSameScene_(parsed, read), name + ": binary", numFailed);
+			Scene fromBinary;
+			addToScene(binary, fromBinary);
+			check(isSameScene_(serial, fromBinary), name + ": addToScene from binary", numFailed);
+		}
+		check(convertSceneFile(binaryPath.string(), path2.string(), error) == SceneFileStatus::OK &&
+			  readText_(path2) == readText_(path), name + ": text to binary to text", numFailed);
+	}
+
+	//	Parallel parse, on a text larger than the size at which the parse is split
+	{
+		SceneFileData data;
+		check(parseSceneFile(makeText_(makeTestScene(TestDistribution::SHORT, 100000, 2)), data, error, 1) ==
+			  SceneFileStatus::OK, "parse large text", numFailed);
+		Scene scene;
+		addToScene(data, scene);
+		findAllIntersectionsGrid(scene.getAllSegments(), data.intersections);
+		check(writeSceneFile(path.string(), data, error) == SceneFileStatus::OK, "write large text", numFailed);
+		string text = readText_(path);
+		SceneFileData serial, parallel;
+		check(parseSceneFile(text, serial, error, 1) == SceneFileStatus::OK && isSameScene_(data, serial),
+			  "sequential parse", numFailed);
+		check(parseSceneFile(text, parallel, error, 4) == SceneFileStatus::OK && isSameScene_(data, parallel),
+			  "parallel parse", numFailed);
+
+		//	an invalid segment in the middle of the text
+		const size_t badLine = text.find("\ns ", text.size() / 2) + 1;
+		text.replace(badLine, 2, "s x");
+		const size_t badLineNumber = static_cast<size_t>(count(text.begin(), text.begin() + badLine, '\n')) + 1;
+		SceneFileError serialError, parallelError;
+		serial = SceneFileData();
+		parallel = SceneFileData();
+		check(parseSceneFile(text, serial, serialError, 1) == SceneFileStatus::INVALID_RECORD &&
+			  serialError.lineNumber == badLineNumber, "sequential parse of an invalid record", numFailed);
+		check(parseSceneFile(text, parallel, parallelError, 4) == SceneFileStatus::INVALID_RECORD &&
+			  parallelError.lineNumber == serialError.lineNumber && parallelError.message == serialError.message,
+			  "parallel parse of an invalid record", numFailed);
+	}
+
+	//	A binary file cut short is rejected rather than read past its end
+	const string binaryText = readText_(binaryPath);
+	{
+		ofstream out(binaryPath, ios::binary);
+		out << binaryText.substr(0, binaryText.size() - 4);
+	}
+	BinarySceneFile binary;
+	check(binary.open(binaryPath.string(), error) == SceneFileStatus::INVALID_BINARY_FILE,
+		  "truncated binary file", numFailed);
+	for (const filesystem::path& file : {path, binaryPath, path2}){
+		filesystem::remove(file);
+	}
+	return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+//
+//  sceneGeneratorTest.cpp
+//
+//	Checks that the scene generator is reproducible (the same settings give the same
+//	scene, another seed another one), that the crossings it reports are those that the
+//	searches find once the scene is loaded, and that a target number of crossings is
+//	reached within the tolerance.
+//	Returns 0 if all the checks passed.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include "Scene.hpp"
+#include "Segment.hpp"
+#include "SceneFile.hpp"
+#include "SceneGenerator.hpp"
+#include "TestScenes.hpp"
+
+using namespace std;
+using namespace geometry;
+
+/**	@return true if the scenes have the same points (bit for bit) and segments */
+static bool isSameScene_(const SceneFileData& a, const SceneFileData& b){
+	if (a.points.size() != b.points.size() || a.segments != b.segments){
+		return false;
+	}
+	for (size_t k=0; k<a.points.size(); k++){
+		if (a.points[k].x != b.points[k].x || a.points[k].y != b.points[k].y){
+			return false;
+		}
+	}
+	return true;
+}
+
+/**	@return true if the world of the scene holds the square of the settings and all the points */
+static bool isInWorld_(const SceneFileData& data, float worldSize){
+	if (data.xmin > 0.f || data.ymin > 0.f || data.xmax < worldSize || data.ymax < worldSize){
+		return false;
+	}
+	for (const PointStruct& pt : data.points){
+		if (!(pt.x >= data.xmin && pt.x <= data.xmax && pt.y >= data.ymin && pt.y <= data.ymax)){
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(void){
+	size_t numFailed = 0;
+	for (SceneDistribution distribution : {SceneDistribution::UNIFORM, SceneDistribution::SHORT, SceneDistribution::LONG,
+										   SceneDistribution::GRID, SceneDistribution::DEGENERATE}){
+		const string name = getDistributionName(distribution);
+		SceneGeneratorSettings settings;
+		settings.distribution = distribution;
+		settings.numSegments = 2000;
+		settings.countCrossings = true;
+
+		SceneFileData first, again, other;
+		SceneGeneratorStats stats;
+		generateScene(settings, first, &stats);
+		generateScene(settings, again);
+		settings.seed = 2;
+		generateScene(settings, other);
+		check(first.segments.size() == settings.numSegments && isInWorld_(first, settings.worldSize),
+			  name + ": size of the scene", numFailed);
+		check(isSameScene_(first, again), name + ": same seed, same scene", numFailed);
+		check(!isSameScene_(first, other), name + ": other seed, other scene", numFailed);
+
+		//	the crossings counted are those that the brute force finds in the loaded scene
+		Scene scene;
+		addToScene(first, scene);
+		vector<IntersectionRecord> found;
+		findAllIntersectionsBruteForce(scene.getAllSegments(), found);
+		check(scene.getAllSegments().size() == first.segments.size() && stats.crossingsCounted &&
+			  stats.numCrossings == found.size() && countCrossings(first) == found.size(),
+			  name + ": crossings counted", numFailed);
+
+		//	a target of crossings, half of those of the natural scale (more may not be reachable:
+		//	the lines of GRID cross at most once each)
+		settings.seed = 1;
+		settings.countCrossings = false;
+		settings.targetCrossings = stats.numCrossings / 2;
+		settings.tolerance = 0.05;
+		SceneFileData scaled;
+		SceneGeneratorStats scaledStats;
+		generateScene(settings, scaled, &scaledStats);
+		const double error = fabs(static_cast<double>(scaledStats.numCrossings) - static_cast<double>(settings.targetCrossings));
+		check(scaledStats.crossingsCounted && scaledStats.numCrossings == countCrossings(scaled) &&
+			  error <= settings.tolerance * static_cast<double>(settings.targetCrossings),
+			  name + ": " + to_string(scaledStats.numCrossings) + " crossings for a target of " +
+			  to_string(settings.targetCrossings), numFailed);
+	}
+	return numFailed == 0 ? 0 : 1;
+}
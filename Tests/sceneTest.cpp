@@ -0,0 +1,62 @@
+//
+//  sceneTest.cpp
+//
+//	Checks that a Scene other than the default one is self-contained: the handle
+//	(PointId/SegmentId) overloads of Segment and the searches must read the points of
+//	the scene of the segment, not those of the default scene, which holds other points
+//	at the same indices.
+//	Returns 0 if all the checks passed.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Scene.hpp"
+#include "Segment.hpp"
+#include "TestScenes.hpp"
+
+using namespace std;
+using namespace geometry;
+
+int main(void){
+	size_t numFailed = 0;
+
+	//	the default scene: two segments that don't cross, far from those of the local scene
+	Segment::clearAllSegments();
+	Point::clearAllPoints();
+	Segment::makeNewSegPtr(Point::makeNewPointPtr(100.f, 100.f), Point::makeNewPointPtr(110.f, 100.f));
+	Segment::makeNewSegPtr(Point::makeNewPointPtr(100.f, 101.f), Point::makeNewPointPtr(110.f, 102.f));
+
+	//	the local scene: ab and cd cross at (5, 0)
+	Scene scene;
+	const PointId a = scene.makeNewPointId(0.f, 0.f);
+	const PointId b = scene.makeNewPointId(10.f, 0.f);
+	const PointId c = scene.makeNewPointId(5.f, 5.f);
+	const PointId d = scene.makeNewPointId(5.f, -5.f);
+	const SegmentId ab = scene.makeNewSegId(a, b);
+	const SegmentId cd = scene.makeNewSegId(c, d);
+	const Segment& segAB = scene.getSegment(ab);
+	const Segment& segCD = scene.getSegment(cd);
+
+	check(&segAB.getScene() == &scene, "the segment knows its scene", numFailed);
+	check(segAB.isOnLeftSide(c) == segAB.isOnLeftSide(scene.getCoordinates(c)) &&
+		  segAB.isOnLeftSide(d) == segAB.isOnLeftSide(scene.getCoordinates(d)),
+		  "isOnLeftSide(PointId) reads the scene of the segment", numFailed);
+	check(segAB.isOnLeftSide(c) != segAB.isOnLeftSide(d), "c and d are on both sides of ab", numFailed);
+	check(segAB.intersects(cd) && segCD.intersects(ab), "intersects(SegmentId)", numFailed);
+	PointStruct interPt;
+	check(segAB.findIntersection(cd, interPt) && interPt.x == 5.f && interPt.y == 0.f,
+		  "findIntersection(SegmentId)", numFailed);
+
+	vector<IntersectionRecord> found;
+	findAllIntersectionsBruteForce(scene.getAllSegments(), found);
+	check(found.size() == 1, "brute force on the local scene", numFailed);
+	findAllIntersectionsSmart(scene.getAllSegments(), found);
+	check(found.size() == 1, "sweep on the local scene", numFailed);
+	findAllIntersectionsGrid(scene.getAllSegments(), found);
+	check(found.size() == 1, "grid on the local scene", numFailed);
+	findAllIntersectionsBruteForce(Segment::getAllSegments(), found);
+	check(found.empty() && Point::getAllPoints().size() == 4 && Segment::getAllSegments().size() == 2,
+		  "the default scene is left alone", numFailed);
+	return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+//
+//  searchTest.cpp
+//
+//	Compares the intersection searches (parallel brute force, grid) with the brute force
+//	on random scenes of all the distributions, and with the sweep after a point has moved.
+//	Returns 0 if they all found the same intersections as the brute force.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include "Segment.hpp"
+#include "TestScenes.hpp"
+
+using namespace std;
+using namespace geometry;
+
+static const TestScenes TEST_SCENES[] = {
+	{TestDistribution::UNIFORM, 1000, 1, 3},
+	{TestDistribution::SHORT, 3000, 1, 3},
+	{TestDistribution::LONG, 300, 1, 3},
+	{TestDistribution::GRID, 1000, 1, 3},
+	{TestDistribution::DEGENERATE, 1000, 1, 3}
+};
+
+int main(void){
+	size_t numFailed = 0;
+	for (const TestScenes& test : TEST_SCENES){
+		for (uint64_t seed=test.firstSeed; seed<test.firstSeed+test.numSeeds; seed++){
+			const string name = string(getDistributionName(test.distribution)) + " " + to_string(test.numSegments)
+								+ " seed " + to_string(seed);
+			const vector<shared_ptr<Segment> >& segments = loadTestScene(makeTestScene(test.distribution, test.numSegments, seed));
+			vector<IntersectionRecord> expected, found;
+			findAllIntersectionsBruteForce(segments, expected);
+			check(!expected.empty(), name + ": the scene has intersections", numFailed);
+
+			//	the searches that return the records in the order of the brute force
+			findAllIntersectionsBruteForceParallel(segments, found, 4, true);
+			check(isSameList(expected, found), name + ": deterministic parallel brute force", numFailed);
+			findAllIntersectionsGrid(segments, found);
+			check(isSameList(expected, found), name + ": grid", numFailed);
+
+			//	the others, in any order
+			findAllIntersectionsBruteForceParallel(segments, found, 4, false);
+			check(countDifferences(expected, found) == 0, name + ": parallel brute force", numFailed);
+			for (float cellSize : {1.f, 50.f, 1000.f}){
+				findAllIntersectionsGrid(segments, found, cellSize);
+				check(countDifferences(expected, found) == 0, name + ": grid of cells of " + to_string(cellSize), numFailed);
+			}
+
+			check(countAllIntersections(segments) == expected.size(), name + ": count", numFailed);
+
+			//	the searches read the coordinates from the snapshot, which must follow a moved point
+			const shared_ptr<Point> moved = segments[0]->getP1();
+			moved->setCoordinates(500.f, 500.f);
+			check(Point::makeNewPointPtr(500.f, 500.f) == moved, name + ": moved point found at its new place", numFailed);
+			findAllIntersectionsSmart(segments, expected);
+			findAllIntersectionsBruteForce(segments, found);
+			check(countDifferences(expected, found) == 0, name + ": brute force after a point moved", numFailed);
+			findAllIntersectionsGrid(segments, found);
+			check(countDifferences(expected, found) == 0, name + ": grid after a point moved", numFailed);
+		}
+	}
+	return numFailed == 0 ? 0 : 1;
+}
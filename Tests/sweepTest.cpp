@@ -0,0 +1,77 @@
+//
+//  sweepTest.cpp
+//
+//	Compares the plane sweep (findAllIntersectionsSmart) with the brute force on
+//	random scenes, among them many of long segments, whose nearly horizontal segments
+//	and crossings that round to the same point are the hard cases of the sweep, and
+//	scenes of segments that share endpoints, overlap or end on another one.
+//	Returns 0 if the sweep found the same intersections on all the scenes.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Segment.hpp"
+#include "TestScenes.hpp"
+
+using namespace std;
+using namespace geometry;
+
+static const TestScenes TEST_SCENES[] = {
+	{TestDistribution::LONG, 1500, 1, 2},
+	{TestDistribution::LONG, 200, 1, 60},
+	{TestDistribution::LONG, 30, 1, 200},
+	{TestDistribution::UNIFORM, 2000, 1, 3},
+	{TestDistribution::SHORT, 5000, 1, 5},
+	{TestDistribution::GRID, 1000, 1, 10},
+	{TestDistribution::DEGENERATE, 1000, 1, 10}
+};
+
+/**	@return the edges of a triangulated lattice of n x n squares: a clean network,
+ *	whose segments only meet at their endpoints
+ */
+static vector<TestSegment> makeTriangulatedGrid_(int n){
+	vector<TestSegment> segments;
+	for (int i=0; i<=n; i++){
+		for (int j=0; j<=n; j++){
+			const float x = static_cast<float>(i), y = static_cast<float>(j);
+			if (i < n){
+				segments.push_back(TestSegment{x, y, x + 1.f, y});
+			}
+			if (j < n){
+				segments.push_back(TestSegment{x, y, x, y + 1.f});
+			}
+			if (i < n && j < n){
+				segments.push_back(TestSegment{x, y, x + 1.f, y + 1.f});
+			}
+		}
+	}
+	return segments;
+}
+
+int main(void){
+	size_t numFailed = 0;
+	{
+		const vector<shared_ptr<Segment> >& segments = loadTestScene(makeTriangulatedGrid_(20));
+		vector<IntersectionRecord> found;
+		findAllIntersectionsBruteForce(segments, found);
+		check(found.empty(), "triangulated grid: brute force", numFailed);
+		findAllIntersectionsSmart(segments, found);
+		check(found.empty(), "triangulated grid: sweep", numFailed);
+		check(countAllIntersections(segments) == 0, "triangulated grid: count", numFailed);
+		check(!anyIntersection(segments), "triangulated grid: anyIntersection", numFailed);
+	}
+	for (const TestScenes& test : TEST_SCENES){
+		for (uint64_t seed=test.firstSeed; seed<test.firstSeed+test.numSeeds; seed++){
+			const string name = string(getDistributionName(test.distribution)) + " " + to_string(test.numSegments)
+								+ " seed " + to_string(seed);
+			const vector<shared_ptr<Segment> >& segments = loadTestScene(makeTestScene(test.distribution, test.numSegments, seed));
+			vector<IntersectionRecord> expected, found;
+			findAllIntersectionsBruteForce(segments, expected);
+			findAllIntersectionsSmart(segments, found);
+			check(countDifferences(expected, found) == 0, name + ": sweep", numFailed);
+			check(anyIntersection(segments) == !expected.empty(), name + ": anyIntersection", numFailed);
+		}
+	}
+	return numFailed == 0 ? 0 : 1;
+}
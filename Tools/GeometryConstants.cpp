@@ -0,0 +1,15 @@
+//
+//  GeometryConstants.cpp
+//
+//	The tolerances of the Geometry class for the command-line tools and the tests
+//	(the demo defines its own in pointsAndSegments.cpp), the same as those of the demo.
+//
+
+#include "Geometry.hpp"
+
+using namespace geometry;
+
+const float Geometry::DISTANCE_ABS_TOL = 1E-8f;
+const float Geometry::DISTANCE_REL_TOL = 1E-6f;
+const float Geometry::DISTANCE_ABS_SQ_TOL = 1E-15f;
+const float Geometry::DISTANCE_REL_SQ_TOL = 1E-8f;
@@ -0,0 +1,27 @@
+//
+//  sceneConvert.cpp
+//
+//	Converts a scene file from the text format to the binary one, or the
+//	other way around:
+//		sceneConvert <input file> <output file>
+//
+
+#include <iostream>
+#include "SceneFile.hpp"
+
+using namespace std;
+using namespace geometry;
+
+int main(int argc, char* argv[]){
+	if (argc != 3){
+		cout << "Usage: " << argv[0] << " <input file> <output file>" << endl;
+		cout << "\tConverts a text scene file to the binary format, or a binary one to text" << endl;
+		return 1;
+	}
+	SceneFileError error;
+	if (convertSceneFile(argv[1], argv[2], error) != SceneFileStatus::OK){
+		cout << error.message << endl;
+		return static_cast<int>(error.status);
+	}
+	return 0;
+}
@@ -0,0 +1,108 @@
+//
+//  sceneGenerate.cpp
+//
+//	Writes a random scene, the same for the same options:
+//		sceneGenerate [-g <distribution>] [-n <segments>] [-c <crossings>] [-w <world size>] [-s <seed>]
+//					  [-k] [-b] <output file>
+//	Prints the number of segments and, if they were counted, of crossings of the scene.
+//
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "SceneFile.hpp"
+#include "SceneGenerator.hpp"
+
+using namespace std;
+using namespace geometry;
+
+struct Options{
+	SceneGeneratorSettings settings;
+	bool binary = false;
+	string outFilePath;
+};
+
+static void printUsage(const char* program){
+	cout << "Usage: " << program << " [-g <distribution>] [-n <segments>] [-c <crossings>] [-w <world size>] [-s <seed>]" << endl;
+	cout << "\t\t[-k] [-b] <output file>" << endl;
+	cout << "\t-g\tuniform, short (default), long, grid or degenerate" << endl;
+	cout << "\t-n\tnumber of segments (default: 1000)" << endl;
+	cout << "\t-c\tnumber of crossings the segments are scaled to have (default: the natural scale)" << endl;
+	cout << "\t-w\tside of the square world (default: 1000)" << endl;
+	cout << "\t-s\tseed (default: 1)" << endl;
+	cout << "\t-k\tcount the crossings of a scene generated without -c" << endl;
+	cout << "\t-b\twrite the binary format instead of the text one" << endl;
+}
+
+/**	@return false if the command line is invalid */
+static bool parseOptions(int argc, char* argv[], Options& options){
+	SceneGeneratorSettings& settings = options.settings;
+	for (int k=1; k<argc; k++){
+		const string arg = argv[k];
+		if (arg == "-k"){
+			settings.countCrossings = true;
+		}else if (arg == "-b"){
+			options.binary = true;
+		}else if (arg == "-g" || arg == "-n" || arg == "-c" || arg == "-w" || arg == "-s"){
+			if (++k == argc){
+				return false;
+			}
+			const string value = argv[k];
+			if (arg == "-g"){
+				if (!parseDistributionName(value, settings.distribution)){
+					return false;
+				}
+			}else if (arg == "-n"){
+				const long long numSegments = atoll(value.c_str());
+				if (numSegments <= 0){
+					return false;
+				}
+				settings.numSegments = static_cast<size_t>(numSegments);
+			}else if (arg == "-c"){
+				const long long numCrossings = atoll(value.c_str());
+				if (numCrossings < 0){
+					return false;
+				}
+				settings.targetCrossings = static_cast<size_t>(numCrossings);
+			}else if (arg == "-w"){
+				settings.worldSize = static_cast<float>(atof(value.c_str()));
+				if (!(settings.worldSize > 0.f)){
+					return false;
+				}
+			}else{
+				settings.seed = strtoull(value.c_str(), nullptr, 10);
+			}
+		}else if (options.outFilePath.empty() && arg[0] != '-'){
+			options.outFilePath = arg;
+		}else{
+			return false;
+		}
+	}
+	return !options.outFilePath.empty();
+}
+
+int main(int argc, char* argv[]){
+	Options options;
+	if (!parseOptions(argc, argv, options)){
+		printUsage(argv[0]);
+		return 1;
+	}
+	SceneFileData data;
+	SceneGeneratorStats stats;
+	generateScene(options.settings, data, &stats);
+
+	SceneFileError error;
+	const SceneFileStatus status = options.binary ? writeBinarySceneFile(options.outFilePath, data, error)
+												  : writeSceneFile(options.outFilePath, data, error);
+	if (status != SceneFileStatus::OK){
+		cout << error.message << endl;
+		return static_cast<int>(error.status);
+	}
+	cout << data.segments.size() << " segments (" << getDistributionName(options.settings.distribution)
+		 << ", scale " << stats.scale << ")";
+	if (stats.crossingsCounted){
+		cout << ", " << stats.numCrossings << " crossings";
+	}
+	cout << endl;
+	return 0;
+}
@@ -0,0 +1,655 @@
+//
+//  segmentBenchmark.cpp
+//
+//	Times the registries, the intersection searches and the scene file input and output
+//	on generated scenes, and writes the results as JSON so that runs of different
+//	commits can be compared:
+//		segmentBenchmark [-g <distribution>] [-n <sizes>] [-d <densities>] [-r <repetitions>] [-b <benchmarks>]
+//						 [-t <threads>] [-B <brute force limit>] [-m <memory MiB>] [-s <seed>]
+//						 [-l <label>] [-o <output file>]
+//	The scenes are made by the scene generator, with n segments scaled to cross d others
+//	on average, and only depend on the seed.
+//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <ctime>
+#include <sys/resource.h>
+#include <unistd.h>
+#include "Scene.hpp"
+#include "Segment.hpp"
+#include "SegmentSoA.hpp"
+#include "Predicates.hpp"
+#include "ConcurrentRegistry.hpp"
+#include "SceneFile.hpp"
+#include "OutOfCore.hpp"
+#include "SceneGenerator.hpp"
+#include "Counters.hpp"
+
+using namespace std;
+using namespace geometry;
+
+/**	Version of the layout of the JSON output, to be changed with the layout */
+#define JSON_FORMAT_VERSION 1
+
+#if 0
+//----------------------------------------------------------------------------------
+#pragma mark -
+#pragma mark Options
+//----------------------------------------------------------------------------------
+#endif
+
+struct Options{
+	SceneDistribution distribution = SceneDistribution::SHORT;
+	vector<size_t> sizes = {1000, 10000, 100000};
+	/**	average numbers of crossings per segment */
+	vector<double> densities = {0.1, 1.0, 10.0};
+	unsigned int repetitions = 3;
+	/**	names of the benchmarks to run, all of them if empty */
+	vector<string> benchmarks;
+	unsigned int numThreads = 0;
+	/**	largest scene the quadratic searches are run on */
+	size_t bruteForceLimit = 20000;
+	size_t memoryBudget = OutOfCoreSettings().memoryBudget;
+	uint64_t seed = 1;
+	string label;
+	string outFilePath;
+};
+
+/**	The benchmarks, in the order they run */
+static const char* const BENCHMARK_NAMES[] = {
+	"orientation", "orientation_float",
+	"insert", "insert_bulk", "insert_concurrent",
+	"brute_force", "brute_force_parallel", "sweep", "grid", "grid_soa",
+	"write_text", "read_text", "write_binary", "open_binary", "out_of_core"
+};
+
+static void printUsage(const char* program){
+	cerr << "Usage: " << program << " [-g <distribution>] [-n <sizes>] [-d <densities>] [-r <repetitions>] [-b <benchmarks>]" << endl;
+	cerr << "\t\t[-t <threads>] [-B <brute force limit>] [-m <memory MiB>] [-s <seed>] [-l <label>] [-o <output file>]" << endl;
+	cerr << "\t-g\tdistribution of the segments: uniform, short (default), long, grid or degenerate" << endl;
+	cerr << "\t-n\tcomma-separated numbers of segments (default: 1000,10000,100000)" << endl;
+	cerr << "\t-d\tcomma-separated average numbers of crossings per segment (default: 0.1,1,10)" << endl;
+	cerr << "\t-r\trepetitions of each measure, of which the median is reported (default: 3)" << endl;
+	cerr << "\t-b\tcomma-separated benchmarks to run (default: all):" << endl << "\t\t";
+	for (const char* name : BENCHMARK_NAMES){
+		cerr << " " << name;
+	}
+	cerr << endl;
+	cerr << "\t-t\tnumber of threads of the parallel benchmarks (default: all); insert_concurrent" << endl;
+	cerr << "\t\tis run with 1, 2, 4... threads up to that number" << endl;
+	cerr << "\t-B\tlargest number of segments brute_force and brute_force_parallel run on (default: 20000)" << endl;
+	cerr << "\t-m\tmemory budget of out_of_core, in MiB (default: 256)" << endl;
+	cerr << "\t-s\tseed of the generated scenes (default: 1)" << endl;
+	cerr << "\t-l\tlabel stored in the output, such as the commit measured" << endl;
+	cerr << "\t-o\tJSON output file (default: standard output)" << endl;
+}
+
+/**	Splits a comma-separated list
+ */
+static vector<string> splitList_(const string& list){
+	vector<string> items;
+	stringstream stream(list);
+	string item;
+	while (getline(stream, item, ',')){
+		if (!item.empty()){
+			items.push_back(item);
+		}
+	}
+	return items;
+}
+
+/**	@return false if the command line is invalid */
+static bool parseOptions(int argc, char* argv[], Options& options){
+	for (int k=1; k<argc; k++){
+		const string arg = argv[k];
+		if (arg.size() != 2 || arg[0] != '-' || string("gndrbtBmslo").find(arg[1]) == string::npos || ++k == argc){
+			return false;
+		}
+		const string value = argv[k];
+		switch (arg[1]){
+			case 'g':
+				if (!parseDistributionName(value, options.distribution)){
+					return false;
+				}
+				break;
+			case 'n':
+				options.sizes.clear();
+				for (const string& item : splitList_(value)){
+					const long long size = atoll(item.c_str());
+					if (size <= 0){
+						return false;
+					}
+					options.sizes.push_back(static_cast<size_t>(size));
+				}
+				if (options.sizes.empty()){
+					return false;
+				}
+				break;
+			case 'd':
+				options.densities.clear();
+				for (const string& item : splitList_(value)){
+					const double density = atof(item.c_str());
+					if (!(density > 0.0)){
+						return false;
+					}
+					options.densities.push_back(density);
+				}
+				if (options.densities.empty()){
+					return false;
+				}
+				break;
+			case 'r':
+				if (atoi(value.c_str()) <= 0){
+					return false;
+				}
+				options.repetitions = static_cast<unsigned int>(atoi(value.c_str()));
+				break;
+			case 'b':
+				options.benchmarks = splitList_(value);
+				for (const string& name : options.benchmarks){
+					if (find(begin(BENCHMARK_NAMES), end(BENCHMARK_NAMES), name) == end(BENCHMARK_NAMES)){
+						return false;
+					}
+				}
+				break;
+			case 't':
+				options.numThreads = static_cast<unsigned int>(atoi(value.c_str()));
+				break;
+			case 'B':
+				options.bruteForceLimit = static_cast<size_t>(atoll(value.c_str()));
+				break;
+			case 'm':
+				if (atoll(value.c_str()) <= 0){
+					return false;
+				}
+				options.memoryBudget = static_cast<size_t>(atoll(value.c_str())) << 20;
+				break;
+			case 's':
+				options.seed = strtoull(value.c_str(), nullptr, 10);
+				break;
+			case 'l':
+				options.label = value;
+				break;
+			default:
+				options.outFilePath = value;
+				break;
+		}
+	}
+	return true;
+}
+
+#if 0
+//----------------------------------------------------------------------------------
+#pragma mark -
+#pragma mark Measures
+//----------------------------------------------------------------------------------
+#endif
+
+/**	Starts a new measure of the peak resident set size.  Linux resets the high-water mark
+ *	of a process when it writes 5 to its clear_refs; elsewhere the peak stays the one of
+ *	the whole process.
+ *	@return true if the peak was reset
+ */
+static bool resetPeakRss_(void){
+#if defined(__linux__)
+	ofstream clearRefs("/proc/self/clear_refs");
+	clearRefs << "5" << endl;
+	return clearRefs.good();
+#else
+	return false;
+#endif
+}
+
+/**	@return the peak resident set size since the last reset, in bytes
+ */
+static size_t peakRss_(void){
+#if defined(__linux__)
+	ifstream status("/proc/self/status");
+	string line;
+	while (getline(status, line)){
+		if (line.compare(0, 6, "VmHWM:") == 0){
+			return static_cast<size_t>(atoll(line.c_str() + 6)) << 10;
+		}
+	}
+#endif
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+	return static_cast<size_t>(usage.ru_maxrss);
+#else
+	return static_cast<size_t>(usage.ru_maxrss) << 10;
+#endif
+}
+
+/**	Where the benchmarks store what they compute only to keep it from being optimized away */
+static volatile unsigned int checksum_ = 0;
+
+/**	Result of a benchmark on a scene
+ */
+struct Measure{
+	string name;
+	size_t numSegments = 0;
+	double density = 0.0;
+	/**	times of the repetitions, in seconds, sorted */
+	vector<double> times;
+	/**	whether the benchmark is a search, and the intersections it found */
+	bool isSearch = false;
+	size_t numIntersections = 0;
+	/**	size of the file read or written, for the file benchmarks */
+	size_t numBytes = 0;
+	/**	number of threads, for the benchmarks run with several */
+	unsigned int numThreads = 0;
+	size_t peakRss = 0;
+	/**	counts of the library (if built with GEOMETRY_COUNTERS), per repetition */
+	CounterValues counters;
+};
+
+/**	A benchmark times itself (so that it can leave its setup out) and returns seconds
+ */
+typedef function<double(Measure&)> Benchmark;
+
+static double secondsSince_(chrono::steady_clock::time_point start){
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static Measure runBenchmark_(const string& name, size_t numSegments, double density, unsigned int repetitions,
+							 const Benchmark& benchmark){
+	Measure measure;
+	measure.name = name;
+	measure.numSegments = numSegments;
+	measure.density = density;
+	resetPeakRss_();
+	resetCounters();
+	for (unsigned int k=0; k<repetitions; k++){
+		measure.times.push_back(benchmark(measure));
+	}
+	measure.peakRss = peakRss_();
+	measure.counters = getCounters();
+	for (uint64_t& count : measure.counters.values){
+		count /= repetitions;
+	}
+	sort(measure.times.begin(), measure.times.end());
+	return measure;
+}
+
+#if 0
+//----------------------------------------------------------------------------------
+#pragma mark -
+#pragma mark JSON output
+//----------------------------------------------------------------------------------
+#endif
+
+static string jsonString_(const string& text){
+	string quoted = "\"";
+	for (const char c : text){
+		if (c == '"' || c == '\\'){
+			quoted += '\\';
+			quoted += c;
+		}else if (static_cast<unsigned char>(c) < 0x20){
+			char escaped[8];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+			quoted += escaped;
+		}else{
+			quoted += c;
+		}
+	}
+	return quoted + "\"";
+}
+
+static string compilerName_(void){
+#if defined(__clang__)
+	return string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+	return string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+	return "msvc " + to_string(_MSC_VER);
+#else
+	return "unknown";
+#endif
+}
+
+static void writeJson_(ostream& out, const Options& options, unsigned int numThreads, bool rssPerBenchmark,
+					   const vector<Measure>& measures){
+	char date[32];
+	const time_t now = time(nullptr);
+	strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+	out << "{" << endl;
+	out << "\t\"format\": " << JSON_FORMAT_VERSION << "," << endl;
+	out << "\t\"label\": " << jsonString_(options.label) << "," << endl;
+	out << "\t\"date\": " << jsonString_(date) << "," << endl;
+	out << "\t\"compiler\": " << jsonString_(compilerName_()) << "," << endl;
+#if defined(NDEBUG)
+	out << "\t\"assertions\": false," << endl;
+#else
+	out << "\t\"assertions\": true," << endl;
+#endif
+	out << "\t\"counters\": " << (COUNTERS_ENABLED ? "true" : "false") << "," << endl;
+	out << "\t\"hardware_threads\": " << thread::hardware_concurrency() << "," << endl;
+	out << "\t\"threads\": " << numThreads << "," << endl;
+	out << "\t\"distribution\": " << jsonString_(getDistributionName(options.distribution)) << "," << endl;
+	out << "\t\"seed\": " << options.seed << "," << endl;
+	out << "\t\"repetitions\": " << options.repetitions << "," << endl;
+	out << "\t\"peak_rss_scope\": " << jsonString_(rssPerBenchmark ? "benchmark" : "process") << "," << endl;
+	out << "\t\"results\": [";
+	for (size_t k=0; k<measures.size(); k++){
+		const Measure& measure = measures[k];
+		const double median = measure.times[measure.times.size() / 2];
+		const double ops = static_cast<double>(measure.numSegments);
+		out << (k == 0 ? "" : ",") << endl << "\t\t{";
+		out << "\"name\": " << jsonString_(measure.name);
+		out << ", \"n\": " << measure.numSegments;
+		out << ", \"density\": " << measure.density;
+		out << setprecision(6);
+		out << ", \"seconds\": " << median;
+		out << ", \"ns_per_op\": " << median * 1E9 / ops;
+		out << ", \"ns_per_op_min\": " << measure.times.front() * 1E9 / ops;
+		out << ", \"ops_per_s\": " << ops / median;
+		if (measure.numBytes != 0){
+			out << ", \"bytes\": " << measure.numBytes;
+			out << ", \"mib_per_s\": " << static_cast<double>(measure.numBytes) / (1 << 20) / median;
+		}
+		if (measure.isSearch){
+			out << ", \"intersections\": " << measure.numIntersections;
+		}
+		if (measure.numThreads != 0){
+			out << ", \"threads\": " << measure.numThreads;
+		}
+		out << ", \"peak_rss_bytes\": " << measure.peakRss;
+		if (COUNTERS_ENABLED){
+			out << ", \"counters\": {";
+			for (size_t c=0; c<NUM_COUNTERS; c++){
+				out << (c == 0 ? "" : ", ") << jsonString_(getCounterName(static_cast<Counter>(c))) << ": " << measure.counters.values[c];
+			}
+			out << "}";
+		}
+		out << "}";
+	}
+	out << endl << "\t]" << endl << "}" << endl;
+}
+
+#if 0
+//----------------------------------------------------------------------------------
+#pragma mark -
+#pragma mark Benchmarks
+//----------------------------------------------------------------------------------
+#endif
+
+/**	Runs the benchmarks selected on the scene, and appends their results to measures
+ */
+static void benchmarkScene_(const Options& options, unsigned int numThreads, const filesystem::path& tempDirectory,
+							const SceneFileData& data, double density, vector<Measure>& measures){
+	const size_t n = data.segments.size();
+	const string textPath = (tempDirectory / "scene.txt").string();
+	const string binaryPath = (tempDirectory / "scene.bin").string();
+	const string outPath = (tempDirectory / "intersections.txt").string();
+	const bool quadraticAllowed = n <= options.bruteForceLimit;
+
+	//	The searches share a scene; the insertions make their own
+	Scene scene;
+	addToScene(data, scene);
+	const vector<shared_ptr<Segment> >& segments = scene.getAllSegments();
+	vector<IntersectionRecord> intersections;
+
+	//	The reading benchmarks read the files written beforehand
+	SceneFileError error;
+	if (writeSceneFile(textPath, data, error) != SceneFileStatus::OK ||
+		writeBinarySceneFile(binaryPath, data, error) != SceneFileStatus::OK){
+		cerr << error.message << endl;
+		exit(static_cast<int>(error.status));
+	}
+	const auto checkStatus = [&error](SceneFileStatus status){
+		if (status != SceneFileStatus::OK){
+			cerr << error.message << endl;
+			exit(static_cast<int>(status));
+		}
+	};
+
+	//	insert_concurrent is run with each of these numbers of threads, to show how it scales
+	vector<unsigned int> threadCounts;
+	for (unsigned int count=1; count<numThreads; count*=2){
+		threadCounts.push_back(count);
+	}
+	threadCounts.push_back(numThreads);
+	unsigned int concurrentThreads = numThreads;
+
+	const vector<pair<string, Benchmark> > benchmarks = {
+		//	two orientation tests per segment: the endpoints of the next segment against it
+		{"orientation", [&](Measure& ) {
+			const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			int sum = 0;
+			for (size_t k=0; k<n; k++){
+				const PointStruct& p1 = data.points[data.segments[k].first];
+				const PointStruct& p2 = data.points[data.segments[k].second];
+				const pair<unsigned int, unsigned int>& next = data.segments[(k + 1) % n];
+				sum += orientation(p1.x, p1.y, p2.x, p2.y, data.points[next.first].x, data.points[next.first].y);
+				sum += orientation(p1.x, p1.y, p2.x, p2.y, data.points[next.second].x, data.points[next.second].y);
+			}
+			const double seconds = secondsSince_(start);
+			checksum_ = checksum_ + static_cast<unsigned int>(sum);
+			return seconds;
+		}},
+		//	the same with the float determinant Segment::isOnLeftSide used before, whose sign can be wrong
+		{"orientation_float", [&](Measure& ) {
+			const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			int sum = 0;
+			for (size_t k=0; k<n; k++){
+				const PointStruct& p1 = data.points[data.segments[k].first];
+				const PointStruct& p2 = data.points[data.segments[k].second];
+				const pair<unsigned int, unsigned int>& next = data.segments[(k + 1) % n];
+				sum += orientationDetFloat(p1.x, p1.y, p2.x, p2.y, data.points[next.first].x, data.points[next.first].y) > 0.f;
+				sum += orientationDetFloat(p1.x, p1.y, p2.x, p2.y, data.points[next.second].x, data.points[next.second].y) > 0.f;
+			}
+			const double seconds = secondsSince_(start);
+			checksum_ = checksum_ + static_cast<unsigned int>(sum);
+			return seconds;
+		}},
+		{"insert", [&](Measure& ) {
+			unique_ptr<Scene> target = make_unique<Scene>();
+			const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			for (const pair<unsigned int, unsigned int>& seg : data.segments){
+				const PointStruct& pt1 = data.points[seg.first];
+				const PointStruct& pt2 = data.points[seg.second];
+				target->makeNewSegId(target->makeNewPointId(pt1.x, pt1.y), target->makeNewPointId(pt2.x, pt2.y));
+			}
+			return secondsSince_(start);
+		}},
+		{"insert_bulk", [&](Measure& ) {
+			unique_ptr<Scene> target = make_unique<Scene>();
+			const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			addToScene(data, *target);
+			return secondsSince_(start);
+		}},
+		{"insert_concurrent", [&](Measure& measure) {
+			measure.numThreads = concurrentThreads;
+			unique_ptr<Scene> target = make_unique<Scene>();
+			const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			{
+				ConcurrentRegistry registry(*target);
+				vector<thread> threads;
+				for (unsigned int t=0; t<concurrentThreads; t++){
+					threads.emplace_back([&, t]{
+						for (size_t k=n*t/concurrentThreads; k<n*(t+1)/concurrentThreads; k++){
+							const PointStruct& pt1 = data.points[data.segments[k].first];
+							const PointStruct& pt2 = data.points[data.segments[k].second];
+							registry.makeNewSegId(registry.makeNewPointId(pt1.x, pt1.y), registry.makeNewPointId(pt2.x, pt2.y));
+						}
+					});
+				}
+				for (thread& th : threads){
+					th.join();
+				}
+				registry.commit();
+			}
+			return secondsSince_(start);
+		}},
+		{"brute_force", [&](Measure& measure) {
+			const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			findAllIntersectionsBruteForce(segments, intersections);
+			const double seconds = secondsSince_(start);
+			measure.isSearch = true;
+			measure.numIntersections = intersections.size();
+			return seconds;
+		}},
+		{"brute_force_parallel", [&](Measure& measure) {
+			const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			findAllIntersectionsBruteForceParallel(segments, intersections, numThreads);
+			const double seconds = secondsSince_(start);
+			measure.isSearch = true;
+			measure.numIntersections = intersections.size();
+			return seconds;
+		}},
+		{"sweep", [&](Measure& measure) {
+			const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			findAllIntersectionsSmart(segments, intersections);
+			const double seconds = secondsSince_(start);
+			measure.isSearch = true;
+			measure.numIntersections = intersections.size();
+			return seconds;
+		}},
+		{"grid", [&](Measure& measure) {
+			const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			findAllIntersectionsGrid(segments, intersections);
+			const double seconds = secondsSince_(start);
+			measure.isSearch = true;
+			measure.numIntersections = intersections.size();
+			return seconds;
+		}},
+		//	the snapshot is part of the measure: it is what a caller of this version pays
+		{"grid_soa", [&](Measure& measure) {
+			const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			const SegmentSoA coords(segments);
+			findAllIntersectionsGrid(coords, intersections);
+			const double seconds = secondsSince_(start);
+			measure.isSearch = true;
+			measure.numIntersections = intersections.size();
+			return seconds;
+		}},
+		{"write_text", [&](Measure& measure) {
+			const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			checkStatus(writeSceneFile(textPath, data, error));
+			const double seconds = secondsSince_(start);
+			measure.numBytes = filesystem::file_size(textPath);
+			return seconds;
+		}},
+		{"read_text", [&](Measure& measure) {
+			SceneFileData read;
+			const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			checkStatus(readSceneFile(textPath, read, error, numThreads));
+			const double seconds = secondsSince_(start);
+			measure.numBytes = filesystem::file_size(textPath);
+			return seconds;
+		}},
+		{"write_binary", [&](Measure& measure) {
+			const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			checkStatus(writeBinarySceneFile(binaryPath, data, error));
+			const double seconds = secondsSince_(start);
+			measure.numBytes = filesystem::file_size(binaryPath);
+			return seconds;
+		}},
+		//	the file is mapped, so its segments are visited to make it actually read
+		{"open_binary", [&](Measure& measure) {
+			BinarySceneFile file;
+			const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			checkStatus(file.open(binaryPath, error));
+			unsigned int checksum = 0;
+			for (const pair<unsigned int, unsigned int>& seg : file.getSegments()){
+				checksum += seg.first ^ seg.second;
+			}
+			const double seconds = secondsSince_(start);
+			checksum_ = checksum_ + checksum;
+			measure.numBytes = filesystem::file_size(binaryPath);
+			return seconds;
+		}},
+		{"out_of_core", [&](Measure& measure) {
+			OutOfCoreSettings settings;
+			settings.memoryBudget = options.memoryBudget;
+			settings.tempDirectory = tempDirectory.string();
+			OutOfCoreStats stats;
+			const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			checkStatus(findAllIntersectionsOutOfCore(textPath, outPath, settings, error, &stats));
+			const double seconds = secondsSince_(start);
+			measure.isSearch = true;
+			measure.numIntersections = stats.numIntersections;
+			return seconds;
+		}}
+	};
+
+	for (const pair<string, Benchmark>& benchmark : benchmarks){
+		const string& name = benchmark.first;
+		if ((!options.benchmarks.empty() &&
+			 find(options.benchmarks.begin(), options.benchmarks.end(), name) == options.benchmarks.end()) ||
+			(!quadraticAllowed && name.compare(0, 11, "brute_force") == 0)){
+			continue;
+		}
+		for (unsigned int count : (name == "insert_concurrent") ? threadCounts : vector<unsigned int>{numThreads}){
+			concurrentThreads = count;
+			cerr << "n=" << n << " density=" << density << " " << name;
+			if (name == "insert_concurrent"){
+				cerr << " threads=" << count;
+			}
+			cerr << flush;
+			measures.push_back(runBenchmark_(name, n, density, options.repetitions, benchmark.second));
+			cerr << ": " << fixed << setprecision(3) << measures.back().times[measures.back().times.size() / 2]
+				 << " s" << defaultfloat << endl;
+		}
+	}
+	filesystem::remove(textPath);
+	filesystem::remove(binaryPath);
+	filesystem::remove(outPath);
+}
+
+int main(int argc, char* argv[]){
+	Options options;
+	if (!parseOptions(argc, argv, options)){
+		printUsage(argv[0]);
+		return 1;
+	}
+	const unsigned int numThreads = options.numThreads != 0 ? options.numThreads
+															: max(1U, thread::hardware_concurrency());
+	const bool rssPerBenchmark = resetPeakRss_();
+
+	const filesystem::path tempDirectory = filesystem::temp_directory_path() /
+										   ("segbench-" + to_string(static_cast<long long>(getpid())));
+	filesystem::create_directories(tempDirectory);
+
+	vector<Measure> measures;
+	for (size_t n : options.sizes){
+		for (double density : options.densities){
+			SceneGeneratorSettings settings;
+			settings.distribution = options.distribution;
+			settings.numSegments = n;
+			settings.seed = options.seed;
+			settings.targetCrossings = static_cast<size_t>(llround(0.5 * density * static_cast<double>(n)));
+			SceneFileData data;
+			generateScene(settings, data);
+			benchmarkScene_(options, numThreads, tempDirectory, data, density, measures);
+		}
+	}
+	filesystem::remove_all(tempDirectory);
+
+	if (options.outFilePath.empty()){
+		writeJson_(cout, options, numThreads, rssPerBenchmark, measures);
+	}else{
+		ofstream out(options.outFilePath);
+		writeJson_(out, options, numThreads, rssPerBenchmark, measures);
+		if (!out.good()){
+			cerr << "Could not write " << options.outFilePath << endl;
+			return static_cast<int>(SceneFileStatus::WRITE_FAILED);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,207 @@
+//
+//  segmentIntersect.cpp
+//
+//	Finds the intersections of the segments of a scene file, without any display,
+//	so that it can run as a batch job:
+//		segmentIntersect [-a <algorithm>] [-t <threads>] [-m <memory MiB>] <scene file> [<output file>]
+//	Prints the time spent in each phase, and the counters of the library if it was built
+//	with GEOMETRY_COUNTERS.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include "Scene.hpp"
+#include "Segment.hpp"
+#include "SceneFile.hpp"
+#include "OutOfCore.hpp"
+#include "Counters.hpp"
+
+using namespace std;
+using namespace geometry;
+
+enum class Algorithm{
+	BRUTE_FORCE,
+	BRUTE_FORCE_PARALLEL,
+	GRID,
+	SWEEP,
+	OUT_OF_CORE
+};
+
+struct Options{
+	Algorithm algorithm = Algorithm::GRID;
+	string algorithmName = "grid";
+	unsigned int numThreads = 0;
+	size_t memoryBudget = OutOfCoreSettings().memoryBudget;
+	string sceneFilePath;
+	string outFilePath;
+};
+
+static void printUsage(const char* program){
+	cout << "Usage: " << program << " [-a <algorithm>] [-t <threads>] [-m <memory MiB>] <scene file> [<output file>]" << endl;
+	cout << "\t-a\tbrute, parallel, grid (default), sweep or outofcore" << endl;
+	cout << "\t-t\tnumber of threads of the parallel brute force and of the reading (default: all)" << endl;
+	cout << "\t-m\tmemory budget of outofcore, in MiB (default: 256)" << endl;
+	cout << "\tThe output file is the scene with its intersections, or for outofcore (which needs" << endl;
+	cout << "\tone) the intersections only, as positions of the segments in the scene file." << endl;
+}
+
+/**	@return false if the command line is invalid */
+static bool parseOptions(int argc, char* argv[], Options& options){
+	vector<string> paths;
+	for (int k=1; k<argc; k++){
+		const string arg = argv[k];
+		if (arg == "-a" || arg == "-t" || arg == "-m"){
+			if (++k == argc){
+				return false;
+			}
+			const string value = argv[k];
+			if (arg == "-a"){
+				const pair<const char*, Algorithm> ALGORITHMS[] = {
+					{"brute", Algorithm::BRUTE_FORCE}, {"parallel", Algorithm::BRUTE_FORCE_PARALLEL},
+					{"grid", Algorithm::GRID}, {"sweep", Algorithm::SWEEP}, {"outofcore", Algorithm::OUT_OF_CORE}
+				};
+				bool found = false;
+				for (const auto& algorithm : ALGORITHMS){
+					if (value == algorithm.first){
+						options.algorithm = algorithm.second;
+						options.algorithmName = value;
+						found = true;
+					}
+				}
+				if (!found){
+					return false;
+				}
+			}else if (arg == "-t"){
+				options.numThreads = static_cast<unsigned int>(atoi(value.c_str()));
+			}else{
+				const long long mebibytes = atoll(value.c_str());
+				if (mebibytes <= 0){
+					return false;
+				}
+				options.memoryBudget = static_cast<size_t>(mebibytes) << 20;
+			}
+		}else{
+			paths.push_back(arg);
+		}
+	}
+	if (paths.empty() || paths.size() > 2){
+		return false;
+	}
+	options.sceneFilePath = paths[0];
+	if (paths.size() == 2){
+		options.outFilePath = paths[1];
+	}
+	return options.algorithm != Algorithm::OUT_OF_CORE || !options.outFilePath.empty();
+}
+
+/**	Prints the time of a phase, and restarts the clock */
+static void printPhase(const char* phase, chrono::steady_clock::time_point& start, const string& details){
+	const chrono::steady_clock::time_point now = chrono::steady_clock::now();
+	cout << left << setw(8) << phase << right << fixed << setprecision(3) << setw(10)
+		 << chrono::duration<double>(now - start).count() << " s   " << details << endl;
+	start = now;
+}
+
+/**	Prints the counters of the whole run, if the library counts
+ */
+static void printCounters(void){
+	if (!COUNTERS_ENABLED){
+		return;
+	}
+	const CounterValues counts = getCounters();
+	for (size_t k=0; k<NUM_COUNTERS; k++){
+		cout << left << setw(26) << getCounterName(static_cast<Counter>(k)) << right << setw(16) << counts.values[k] << endl;
+	}
+}
+
+int main(int argc, char* argv[]){
+	Options options;
+	if (!parseOptions(argc, argv, options)){
+		printUsage(argv[0]);
+		return 1;
+	}
+	SceneFileError error;
+	chrono::steady_clock::time_point programStart = chrono::steady_clock::now();
+	chrono::steady_clock::time_point start = programStart;
+
+	if (options.algorithm == Algorithm::OUT_OF_CORE){
+		OutOfCoreSettings settings;
+		settings.memoryBudget = options.memoryBudget;
+		OutOfCoreStats stats;
+		if (findAllIntersectionsOutOfCore(options.sceneFilePath, options.outFilePath, settings, error, &stats)
+				!= SceneFileStatus::OK){
+			cout << error.message << endl;
+			return static_cast<int>(error.status);
+		}
+		printPhase("search", start, to_string(stats.numIntersections) + " intersections of " +
+				   to_string(stats.numSegments) + " segments (outofcore, " + to_string(stats.numStrips) + " strips)");
+		printPhase("total", programStart, "");
+		printCounters();
+		return 0;
+	}
+
+	//	Read the file, then build the scene
+	Scene scene;
+	SceneFileData output;
+	{
+		SceneFileData data;
+		BinarySceneFile file;
+		const bool isBinary = isBinarySceneFile(options.sceneFilePath);
+		const SceneFileStatus status = isBinary ? file.open(options.sceneFilePath, error)
+												: readSceneFile(options.sceneFilePath, data, error, options.numThreads);
+		if (status != SceneFileStatus::OK){
+			cout << error.message << endl;
+			return static_cast<int>(error.status);
+		}
+		output.xmin = isBinary ? file.getXmin() : data.xmin;
+		output.xmax = isBinary ? file.getXmax() : data.xmax;
+		output.ymin = isBinary ? file.getYmin() : data.ymin;
+		output.ymax = isBinary ? file.getYmax() : data.ymax;
+		const size_t numPoints = isBinary ? file.getPoints().size() : data.points.size();
+		const size_t numSegments = isBinary ? file.getSegments().size() : data.segments.size();
+		printPhase("read", start, to_string(numPoints) + " points, " + to_string(numSegments) + " segments");
+
+		if (isBinary){
+			addToScene(file, scene);
+		}else{
+			addToScene(data, scene);
+		}
+		printPhase("scene", start, to_string(scene.getAllPoints().size()) + " points, " +
+				   to_string(scene.getAllSegments().size()) + " segments");
+	}
+
+	vector<IntersectionRecord> intersections;
+	const vector<shared_ptr<Segment> >& segments = scene.getAllSegments();
+	switch (options.algorithm){
+		case Algorithm::BRUTE_FORCE:
+			findAllIntersectionsBruteForce(segments, intersections);
+			break;
+		case Algorithm::BRUTE_FORCE_PARALLEL:
+			findAllIntersectionsBruteForceParallel(segments, intersections, options.numThreads);
+			break;
+		case Algorithm::SWEEP:
+			findAllIntersectionsSmart(segments, intersections);
+			break;
+		default:
+			findAllIntersectionsGrid(segments, intersections);
+			break;
+	}
+	printPhase("search", start, to_string(intersections.size()) + " intersections (" + options.algorithmName + ")");
+
+	if (!options.outFilePath.empty()){
+		copyFromScene(scene, output);
+		output.intersections = std::move(intersections);
+		if (writeSceneFile(options.outFilePath, output, error) != SceneFileStatus::OK){
+			cout << error.message << endl;
+			return static_cast<int>(error.status);
+		}
+		printPhase("write", start, options.outFilePath);
+	}
+	printPhase("total", programStart, "");
+	printCounters();
+	return 0;
+}